@@ -0,0 +1,85 @@
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "thorin/util/stream.h"
+
+#include "impala/arena.h"
+#include "impala/ast.h"
+#include "impala/impala.h"
+#include "impala/source.h"
+
+#include "bench/bench.h"
+
+// count heap allocations of the whole benchmark binary
+static std::atomic<size_t> num_mallocs;
+
+void* operator new(size_t size) {
+    ++num_mallocs;
+    if (auto p = std::malloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace impala::bench {
+
+/**
+ * Measures building and tearing down the AST of a @p Module:
+ * <tt>impala-bench ast [iterations] files...</tt>
+ * Reports the heap allocations during parsing, the allocations served by the @p Module's @p Arena as well as the best
+ * parse and teardown times.
+ */
+int ast(int argc, char** argv) {
+    int iterations = argc > 0 ? std::stoi(argv[0]) : 10;
+
+    std::vector<std::unique_ptr<Source>> sources;
+    size_t bytes = 0;
+    for (int i = 1; i < argc; ++i) {
+        sources.emplace_back(std::make_unique<Source>(argv[i]));
+        bytes += sources.back()->size();
+    }
+    if (sources.empty())
+        throw std::invalid_argument("no input files given");
+
+    double best_parse = 0.0, best_teardown = 0.0;
+    size_t mallocs = 0, arena_allocs = 0, arena_blocks = 0, arena_bytes = 0;
+    for (int i = 0; i != iterations; ++i) {
+        size_t before = num_mallocs;
+        Timer parse_timer;
+        auto arena = std::make_unique<Arena>();
+        std::unique_ptr<const Module> module;
+        {
+            Arena::Scope scope(*arena);
+            Items items;
+            for (const auto& source : sources)
+                parse(items, *source);
+            arena_allocs = arena->num_allocs();
+            arena_blocks = arena->num_blocks();
+            arena_bytes  = arena->num_bytes();
+            module = std::make_unique<const Module>(sources.front()->filename(), std::move(items), std::move(arena));
+        }
+        auto parse_time = parse_timer.elapsed();
+        mallocs = num_mallocs - before;
+
+        Timer teardown_timer;
+        module.reset();
+        auto teardown_time = teardown_timer.elapsed();
+
+        if (i == 0 || parse_time    < best_parse)    best_parse    = parse_time;
+        if (i == 0 || teardown_time < best_teardown) best_teardown = teardown_time;
+    }
+
+    thorin::outf("{} file(s), {} MB", sources.size(), mb(bytes));
+    thorin::outf("heap allocations: {}", mallocs);
+    thorin::outf("arena allocations: {} in {} block(s), {} MB", arena_allocs, arena_blocks, mb(arena_bytes));
+    thorin::outf("best of {}: parse {} ms, teardown {} ms", iterations, best_parse * 1e3, best_teardown * 1e3);
+
+    return num_errors() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}
@@ -0,0 +1,37 @@
+#ifndef IMPALA_BENCH_H
+#define IMPALA_BENCH_H
+
+#include <chrono>
+#include <string>
+
+namespace impala::bench {
+
+class Timer {
+public:
+    Timer()
+        : start_(std::chrono::steady_clock::now())
+    {}
+
+    /// Elapsed wall time in seconds.
+    double elapsed() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count(); }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+/// Generates syntactically valid Impala code of at least @p bytes size.
+std::string synthetic_corpus(size_t bytes);
+
+inline double mb(size_t bytes) { return double(bytes) / (1024.0 * 1024.0); }
+
+int ast(int argc, char** argv);
+int infer(int argc, char** argv);
+int infer_corpus(int argc, char** argv);
+int lexer(int argc, char** argv);
+int parse(int argc, char** argv);
+int symbol(int argc, char** argv);
+int token(int argc, char** argv);
+
+}
+
+#endif
@@ -0,0 +1,28 @@
+#include "bench/bench.h"
+
+namespace impala::bench {
+
+std::string synthetic_corpus(size_t bytes) {
+    std::string result;
+    result.reserve(bytes + 4096);
+
+    for (size_t i = 0; result.size() < bytes; ++i) {
+        auto n = std::to_string(i);
+        result += "/*\n * generated kernel " + n + "\n * computes a weighted sum over a lookup table\n */\n";
+        result += "fn kernel_" + n + "(input_buffer_" + n + ": &[f32], mut accumulator_value: f32) -> f32 {\n";
+        result += "    // coefficients\n";
+        result += "    let table = [0x1F_u32, 0b1010_1010u32, 0o777u32, 123_456u32, 42u32];\n";
+        result += "    let scale = 1.5e-3f + 2.25f * 0.125f;\n";
+        result += "    for i in range(0, " + n + ") {\n";
+        result += "        accumulator_value += input_buffer_" + n + "(i) * scale * (table(i % 5) as f32);\n";
+        result += "        if accumulator_value >= 1000.0f && i != 0 { accumulator_value /= 2.0f; }\n";
+        result += "    }\n";
+        result += "    let name = \"kernel_" + n + "\"; let c = 'x';\n";
+        result += "    accumulator_value\n";
+        result += "}\n\n";
+    }
+
+    return result;
+}
+
+}
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "thorin/util/stream.h"
+
+#include "impala/arena.h"
+#include "impala/ast.h"
+#include "impala/impala.h"
+#include "impala/lexer.h"
+#include "impala/source.h"
+
+#include "bench/bench.h"
+
+namespace impala::bench {
+
+/// Generates a module with @p num_fns functions which only depend on each other's signatures.
+static std::string synthetic_module(size_t num_fns) {
+    std::string result = "fn id[T](x: T) -> T { x }\n\n";
+    result += "fn kernel_0(a: i32, b: f32) -> i32 { a + b as i32 }\n\n";
+
+    for (size_t i = 1; i < num_fns; ++i) {
+        auto n = std::to_string(i), prev = std::to_string(i - 1);
+        result += "fn kernel_" + n + "(a: i32, b: f32) -> i32 {\n";
+        result += "    let mut acc = a;\n";
+        result += "    let scale = id(b) * 2.0f;\n";
+        result += "    let pair = (acc, scale);\n";
+        result += "    let add = |x, y| x + y;\n";
+        result += "    let mut i = 0;\n";
+        result += "    while i < " + n + " {\n";
+        result += "        acc = add(acc, id(i) * kernel_" + prev + "(i, pair(1)));\n";
+        result += "        i += 1;\n";
+        result += "    }\n";
+        result += "    if pair(1) > 1.0f { acc += pair(0); }\n";
+        result += "    acc\n";
+        result += "}\n\n";
+    }
+
+    return result;
+}
+
+/**
+ * Concatenates @p copies copies of all @p filenames.
+ * Each identifier of a file is suffixed with the number of the file and the copy; thus, the copies do not clash but
+ * still pose the very same inference problems.
+ */
+static std::string scaled_corpus(const std::vector<const char*>& filenames, size_t copies) {
+    std::string result;
+    for (size_t f = 0, e = filenames.size(); f != e; ++f) {
+        Source source(filenames[f]);
+        for (size_t c = 0; c != copies; ++c) {
+            auto suffix = "_" + std::to_string(f) + "_" + std::to_string(c);
+            auto last = source.begin();
+            Lexer lexer(source);
+            for (auto tok = lexer.lex(); tok != Token::Eof; tok = lexer.lex()) {
+                auto spelling = tok.spelling();
+                if (tok.tag() == Token::ID && spelling != "_") {
+                    result.append(last, spelling.data() + spelling.size());
+                    result += suffix;
+                    last = spelling.data() + spelling.size();
+                }
+            }
+            result.append(last, source.end());
+            result += "\n";
+        }
+    }
+
+    return result;
+}
+
+struct Result {
+    double time;
+    std::string annotated;
+};
+
+static Result run(const Source& source, size_t num_threads, int iterations) {
+    Result result{0.0, {}};
+    for (int i = 0; i != iterations; ++i) {
+        auto arena = std::make_unique<Arena>();
+        Arena::Scope arena_scope(*arena);
+        Items items;
+        parse(items, source);
+        auto module = std::make_unique<const Module>(source.filename(), std::move(items), std::move(arena));
+        name_analysis(module.get());
+
+        std::unique_ptr<TypeTable> typetable;
+        Timer timer;
+        type_inference(typetable, module.get(), num_threads);
+        auto time = timer.elapsed();
+        if (i == 0 || time < result.time)
+            result.time = time;
+
+        if (i == 0) {
+            std::ostringstream os;
+            Stream s(os);
+            module->stream(s);
+            result.annotated = os.str();
+        }
+    }
+    return result;
+}
+
+/**
+ * Measures how type inference scales when the bodies of independent functions are inferred in parallel and checks
+ * that the annotated AST does not depend on the number of threads:
+ * <tt>impala-bench infer [functions] [max threads] [iterations]</tt>
+ */
+int infer(int argc, char** argv) {
+    size_t num_fns = argc > 0 ? std::stoul(argv[0]) : 4096;
+    size_t max_threads = argc > 1 ? std::stoul(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    auto code = synthetic_module(num_fns);
+    Source source(code, "<synthetic>");
+
+    auto serial = run(source, 1, iterations);
+    if (num_errors() != 0)
+        throw std::runtime_error("synthetic module does not type check");
+
+    thorin::outf("{} function(s)", num_fns);
+    thorin::outf("-j1: {} s", serial.time);
+
+    for (size_t num_threads = 2; num_threads <= max_threads; num_threads *= 2) {
+        auto parallel = run(source, num_threads, iterations);
+        if (parallel.annotated != serial.annotated) {
+            thorin::errf("-j{}: annotated AST differs from -j1", num_threads);
+            return EXIT_FAILURE;
+        }
+        const auto& stats = infer_stats();
+        thorin::outf("-j{}: {} s, speedup {} ({} isolated, {} escaped)",
+                     num_threads, parallel.time, serial.time / parallel.time, stats.isolated, stats.escaped);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Measures type inference on a real corpus - like <tt>test/type_inference/positive/\*.impala</tt> - which is scaled
+ * up by renamed copies:
+ * <tt>impala-bench infer-corpus copies max-threads iterations file...</tt>
+ */
+int infer_corpus(int argc, char** argv) {
+    if (argc < 4)
+        throw std::invalid_argument("usage: infer-corpus copies max-threads iterations file...");
+    size_t copies = std::stoul(argv[0]);
+    size_t max_threads = std::stoul(argv[1]);
+    int iterations = std::stoi(argv[2]);
+    std::vector<const char*> filenames(argv + 3, argv + argc);
+
+    auto code = scaled_corpus(filenames, copies);
+    Source source(code, "<scaled>");
+
+    // some tests of the corpus deliberately leave diagnostics behind; only the time matters here
+    std::ostringstream diagnostics;
+    DiagnosticsScope diagnostics_scope(diagnostics);
+
+    for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        auto result = run(source, num_threads, iterations);
+        const auto& stats = infer_stats();
+        thorin::outf("-j{}: {} file(s) x {} copies, {} unit(s): {} s, {} ns/unit ({} pass(es), {} round(s))",
+                     num_threads, filenames.size(), copies, stats.units, result.time,
+                     result.time * 1e9 / double(stats.units), stats.passes, stats.rounds);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+}
@@ -0,0 +1,58 @@
+#include <sstream>
+
+#include "thorin/util/stream.h"
+
+#include "impala/impala.h"
+#include "impala/lexer.h"
+#include "impala/scan.h"
+#include "impala/source.h"
+
+#include "bench/bench.h"
+
+namespace impala::bench {
+
+template<class F>
+static void run(const std::string& name, size_t bytes, int iterations, F make_lexer) {
+    size_t num_tokens = 0;
+    double best = 0.0;
+    for (int i = 0; i != iterations; ++i) {
+        Timer timer;
+        auto lexer = make_lexer();
+        size_t n = 0;
+        while (lexer->lex() != Token::Eof)
+            ++n;
+        auto time = timer.elapsed();
+        if (i == 0 || time < best)
+            best = time;
+        num_tokens = n;
+    }
+
+    thorin::outf("{}: {} tokens, best of {}: {} s, {} MB/s", name, num_tokens, iterations, best, mb(bytes) / best);
+}
+
+/// Measures @p Lexer throughput in MB/s on a synthetic corpus: <tt>impala-bench lexer [MB] [iterations]</tt>
+int lexer(int argc, char** argv) {
+    size_t size = argc > 0 ? std::stoul(argv[0]) : 16;
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 5;
+    auto corpus = synthetic_corpus(size * 1024 * 1024);
+    thorin::outf("corpus: {} MB", mb(corpus.size()));
+
+    Source source(corpus, "<synthetic>");
+    auto best_isa = scan::best_isa();
+    for (int i = 0; i <= int(best_isa); ++i) {
+        auto isa = scan::ISA(i);
+        scan::set_isa(isa);
+        run(std::string("buffer/") + scan::isa2str(isa), corpus.size(), iterations, [&] { return std::make_unique<Lexer>(source); });
+    }
+
+    std::istringstream stream;
+    run("istream/" + std::string(scan::isa2str(best_isa)), corpus.size(), iterations, [&] {
+        stream.clear();
+        stream.str(corpus);
+        return std::make_unique<Lexer>(stream, "<synthetic>");
+    });
+
+    return num_errors() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}
@@ -0,0 +1,46 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "thorin/util/stream.h"
+
+#include "impala/impala.h"
+
+#include "bench/bench.h"
+
+using namespace impala::bench;
+
+struct Benchmark {
+    const char* name;
+    int (*run)(int argc, char** argv);
+};
+
+static const Benchmark benchmarks[] = {
+    {"ast", ast},
+    {"infer", infer},
+    {"infer-corpus", infer_corpus},
+    {"lexer", lexer},
+    {"parse", parse},
+    {"symbol", symbol},
+    {"token", token},
+};
+
+int main(int argc, char** argv) {
+    try {
+        if (argc >= 2) {
+            for (const auto& benchmark : benchmarks) {
+                if (std::strcmp(argv[1], benchmark.name) == 0) {
+                    impala::init();
+                    return benchmark.run(argc - 2, argv + 2);
+                }
+            }
+        }
+
+        thorin::errf("Usage: {} <benchmark> [args...]", argv[0]);
+        for (const auto& benchmark : benchmarks)
+            thorin::errf("    {}", benchmark.name);
+        return EXIT_FAILURE;
+    } catch (std::exception const& e) {
+        thorin::errf("{}", e.what());
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "thorin/util/stream.h"
+
+#include "impala/arena.h"
+#include "impala/ast.h"
+#include "impala/impala.h"
+#include "impala/source.h"
+
+#include "bench/bench.h"
+
+namespace impala::bench {
+
+static double run(ArrayRef<const Source*> sources, size_t num_threads, int iterations) {
+    double best = 0.0;
+    for (int i = 0; i != iterations; ++i) {
+        Timer timer;
+        Arena arena;
+        Arena::Scope scope(arena);
+        Items items;
+        parse(items, sources, num_threads);
+        auto time = timer.elapsed();
+        if (i == 0 || time < best)
+            best = time;
+    }
+    return best;
+}
+
+/**
+ * Measures how parsing scales with the number of input files when each file is parsed on its own thread:
+ * <tt>impala-bench parse [max files] [KB per file] [threads] [iterations]</tt>
+ * The files are synthetic and of equal size; the time includes merging the items in file order.
+ */
+int parse(int argc, char** argv) {
+    size_t max_files = argc > 0 ? std::stoul(argv[0]) : 64;
+    size_t kb = argc > 1 ? std::stoul(argv[1]) : 256;
+    size_t num_threads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    int iterations = argc > 3 ? std::stoi(argv[3]) : 5;
+
+    auto corpus = synthetic_corpus(kb * 1024);
+    std::vector<std::string> names;
+    std::vector<std::unique_ptr<Source>> sources;
+    for (size_t i = 0; i != max_files; ++i)
+        names.emplace_back("<synthetic " + std::to_string(i) + ">");
+    for (size_t i = 0; i != max_files; ++i)
+        sources.emplace_back(std::make_unique<Source>(corpus, names[i].c_str()));
+
+    thorin::outf("{} MB per file, {} thread(s)", mb(corpus.size()), num_threads);
+    for (size_t num_files = 1;; num_files = std::min(2 * num_files, max_files)) {
+        std::vector<const Source*> ptrs;
+        for (size_t i = 0; i != num_files; ++i)
+            ptrs.emplace_back(sources[i].get());
+
+        auto serial   = run(ptrs, 1, iterations);
+        auto parallel = run(ptrs, num_threads, iterations);
+        auto bytes = num_files * corpus.size();
+        thorin::outf("{} file(s): -j1 {} MB/s, -j{} {} MB/s, speedup {}",
+                     num_files, mb(bytes) / serial, num_threads, mb(bytes) / parallel, serial / parallel);
+        if (num_files == max_files)
+            break;
+    }
+
+    return num_errors() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}
@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "thorin/util/stream.h"
+
+#include "impala/symbol.h"
+
+#include "bench/bench.h"
+
+namespace impala::bench {
+
+/**
+ * Measures how interning @p Symbol%s scales with the number of threads:
+ * <tt>impala-bench symbol [max threads] [distinct names] [lookups per name]</tt>
+ * All threads intern the same names, so the first thread to get to a name inserts it while the others look it up.
+ * Each round uses fresh names such that the table does not simply answer from previous rounds.
+ */
+int symbol(int argc, char** argv) {
+    int max_threads = argc > 0 ? std::stoi(argv[0]) : int(std::max(1u, std::thread::hardware_concurrency()));
+    size_t num_names = argc > 1 ? std::stoul(argv[1]) : 100000;
+    int lookups = argc > 2 ? std::stoi(argv[2]) : 8;
+
+    double base = 0.0;
+    for (int num_threads = 1;; num_threads = std::min(2 * num_threads, max_threads)) {
+        std::vector<std::vector<std::string>> names(num_threads);
+        for (int t = 0; t != num_threads; ++t) {
+            names[t].reserve(num_names);
+            for (size_t i = 0; i != num_names; ++i)
+                names[t].emplace_back("round_" + std::to_string(num_threads) + "_identifier_" + std::to_string(i));
+            // each thread walks the names in a different order to cause contention on different shards
+            std::mt19937 rng(t);
+            std::shuffle(names[t].begin(), names[t].end(), rng);
+        }
+
+        Timer timer;
+        std::vector<std::thread> threads;
+        for (int t = 0; t != num_threads; ++t) {
+            threads.emplace_back([&, t] {
+                for (int l = 0; l != lookups; ++l) {
+                    for (const auto& name : names[t])
+                        thorin::Symbol symbol(name);
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        auto time = timer.elapsed();
+
+        auto ops = double(num_threads) * double(num_names) * double(lookups);
+        auto mops = ops / time * 1e-6;
+        if (num_threads == 1)
+            base = mops;
+        thorin::outf("{} thread(s): {} Mops/s, speedup {}", num_threads, mops, mops / base);
+        if (num_threads == max_threads)
+            break;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+}
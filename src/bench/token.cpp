@@ -0,0 +1,73 @@
+#include <vector>
+
+#include "thorin/util/stream.h"
+
+#include "impala/impala.h"
+#include "impala/lexer.h"
+#include "impala/source.h"
+
+#include "bench/bench.h"
+
+namespace impala::bench {
+
+template<class F>
+static void run(const char* name, size_t num, int iterations, F construct) {
+    double best = 0.0;
+    size_t checksum = 0;
+    for (int i = 0; i != iterations; ++i) {
+        Timer timer;
+        checksum = construct();
+        auto time = timer.elapsed();
+        if (i == 0 || time < best)
+            best = time;
+    }
+
+    thorin::outf("{}: {} tokens, best of {}: {} ns/token (checksum {})", name, num, iterations, best * 1e9 / double(num), checksum);
+}
+
+/**
+ * Measures the construction of @p Token%s from their spellings without the rest of the @p Lexer:
+ * <tt>impala-bench token [MB] [iterations]</tt>
+ */
+int token(int argc, char** argv) {
+    size_t size = argc > 0 ? std::stoul(argv[0]) : 4;
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 5;
+    auto corpus = synthetic_corpus(size * 1024 * 1024);
+
+    std::vector<std::string_view> keywords, identifiers;
+    std::vector<std::pair<Token::Tag, std::string_view>> literals;
+    Source source(corpus, "<synthetic>");
+    Lexer lexer(source);
+    for (auto tok = lexer.lex(); tok != Token::Eof; tok = lexer.lex()) {
+        if (tok.tag() >= Token::LIT_i8 && tok.tag() <= Token::LIT_f64)
+            literals.emplace_back(tok.tag(), tok.spelling());
+        else if (tok.tag() == Token::ID)
+            identifiers.emplace_back(tok.spelling());
+        else if (tok.tag() != Token::LIT_char && tok.tag() != Token::LIT_str && !tok.spelling().empty())
+            keywords.emplace_back(tok.spelling());
+    }
+
+    Loc loc;
+    run("keywords", keywords.size(), iterations, [&] {
+        size_t sum = 0;
+        for (auto spelling : keywords)
+            sum += Token(loc, spelling).tag();
+        return sum;
+    });
+    run("identifiers", identifiers.size(), iterations, [&] {
+        size_t sum = 0;
+        for (auto spelling : identifiers)
+            sum += Token(loc, spelling).tag();
+        return sum;
+    });
+    run("literals", literals.size(), iterations, [&] {
+        size_t sum = 0;
+        for (auto [tag, spelling] : literals)
+            sum += Token(loc, tag, spelling).get();
+        return sum;
+    });
+
+    return num_errors() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}
@@ -0,0 +1,73 @@
+#include "impala/arena.h"
+
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+
+namespace impala {
+
+static thread_local Arena* current_arena = nullptr;
+
+size_t Arena::num_bytes() const {
+    size_t result = 0;
+    for (const auto& block : blocks_)
+        result += block.size;
+    return result;
+}
+
+void* Arena::allocate_slow(size_t size, size_t align) {
+    // oversized requests get a block of their own; we keep bumping in the current block afterwards
+    size_t block = std::max(block_size, size + align);
+    blocks_.push_back({std::unique_ptr<char[]>(new char[block]), block});
+    auto begin = reinterpret_cast<uintptr_t>(blocks_.back().data.get());
+    auto p = (begin + (align - 1)) & ~uintptr_t(align - 1);
+    if (block == block_size) {
+        cur_ = p + size;
+        end_ = begin + block;
+    }
+    return reinterpret_cast<void*>(p);
+}
+
+void Arena::absorb(Arena&& other) {
+    // keep bumping in our current block - other's blocks are merely kept alive
+    blocks_.insert(blocks_.end(), std::make_move_iterator(other.blocks_.begin()), std::make_move_iterator(other.blocks_.end()));
+    num_allocs_ += other.num_allocs_;
+    other.blocks_.clear();
+    other.cur_ = other.end_ = 0;
+    other.num_allocs_ = 0;
+}
+
+Arena* Arena::current() { return current_arena; }
+
+static std::mutex global_mutex;
+
+static Arena& global_arena() {
+    static Arena global;
+    return global;
+}
+
+void* Arena::alloc(size_t size, size_t align) {
+    if (auto arena = current_arena)
+        return arena->allocate(size, align);
+
+    std::lock_guard<std::mutex> lock(global_mutex);
+    return global_arena().allocate(size, align);
+}
+
+void Arena::adopt(Arena&& arena) {
+    if (auto current = current_arena)
+        return current->absorb(std::move(arena));
+
+    std::lock_guard<std::mutex> lock(global_mutex);
+    global_arena().absorb(std::move(arena));
+}
+
+Arena::Scope::Scope(Arena& arena)
+    : prev_(current_arena)
+{
+    current_arena = &arena;
+}
+
+Arena::Scope::~Scope() { current_arena = prev_; }
+
+}
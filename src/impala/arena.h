@@ -0,0 +1,101 @@
+#ifndef IMPALA_ARENA_H
+#define IMPALA_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace impala {
+
+/**
+ * Bump allocator for @p ASTNode%s and their child containers.
+ * Memory is handed out from large blocks and only released when the @p Arena dies - individual deallocations are
+ * no-ops.
+ * An @p Arena is not thread-safe; use one @p Arena per thread and make it the thread's @p current one with a @p Scope.
+ */
+class Arena {
+public:
+    static constexpr size_t block_size = 64 * 1024;
+
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        ++num_allocs_;
+        auto p = (cur_ + (align - 1)) & ~uintptr_t(align - 1);
+        if (p + size > end_)
+            return allocate_slow(size, align);
+        cur_ = p + size;
+        return reinterpret_cast<void*>(p);
+    }
+
+    /// Takes over all blocks of @p other; used to collect the @p Arena%s of worker threads into one.
+    void absorb(Arena&& other);
+
+    size_t num_allocs() const { return num_allocs_; }
+    size_t num_blocks() const { return blocks_.size(); }
+    size_t num_bytes() const; ///< Bytes reserved from the system.
+
+    /// The @p Arena @p ASTNode%s are allocated from on this thread or @c nullptr.
+    static Arena* current();
+
+    /**
+     * Allocates from the @p current @p Arena.
+     * Without a @p current @p Arena the memory comes from a process-wide @p Arena which is guarded by a lock and lives
+     * until exit.
+     */
+    static void* alloc(size_t size, size_t align = alignof(std::max_align_t));
+
+    /// Hands all blocks of @p arena over to the @p current @p Arena or - without one - to the process-wide one.
+    static void adopt(Arena&& arena);
+
+    /// Makes an @p Arena the @p current one of this thread until the @p Scope dies.
+    class Scope {
+    public:
+        Scope(Arena& arena);
+        ~Scope();
+
+    private:
+        Arena* prev_;
+    };
+
+private:
+    void* allocate_slow(size_t size, size_t align);
+
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks_;
+    uintptr_t cur_ = 0;
+    uintptr_t end_ = 0;
+    size_t num_allocs_ = 0;
+};
+
+/// Stateless allocator for the child containers of @p ASTNode%s; see @p Arena::alloc.
+template<class T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    ArenaAllocator() = default;
+    template<class U>
+    ArenaAllocator(const ArenaAllocator<U>&) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(Arena::alloc(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    template<class U> bool operator==(const ArenaAllocator<U>&) const { return true; }
+    template<class U> bool operator!=(const ArenaAllocator<U>&) const { return false; }
+};
+
+template<class T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+template<class T> using ArenaDeque  = std::deque <T, ArenaAllocator<T>>;
+
+}
+
+#endif
@@ -4,12 +4,12 @@ using namespace thorin;
 
 namespace impala {
 
-size_t ASTNode::gid_counter_ = 1;
+std::atomic<size_t> ASTNode::gid_counter_ = 1;
 
 //------------------------------------------------------------------------------
 
 ASTNode::ASTNode(Loc loc)
-    : gid_(gid_counter_++)
+    : gid_(gid_counter_.fetch_add(1, std::memory_order_relaxed))
     , loc_(loc)
 {}
 
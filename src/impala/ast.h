@@ -1,6 +1,7 @@
 #ifndef IMPALA_AST_H
 #define IMPALA_AST_H
 
+#include <atomic>
 #include <vector>
 
 #include "thorin/util/array.h"
@@ -38,21 +39,22 @@ class NameSema;
 class InferSema;
 class TypeSema;
 class CodeGen;
+class Join;
 
 typedef ArrayRef<std::unique_ptr<const ASTType>> ASTTypeArgs;
-typedef std::deque<std::unique_ptr<const Expr>> Exprs;
-typedef std::deque<std::unique_ptr<const Ptrn>> Ptrns;
+typedef ArenaDeque<std::unique_ptr<const Expr>> Exprs;
+typedef ArenaDeque<std::unique_ptr<const Ptrn>> Ptrns;
 typedef std::vector<Symbol> Symbols;
 typedef std::vector<const LocalDecl*> LocalDecls;
 typedef std::vector<std::string> Strings;
-typedef std::vector<std::unique_ptr<const ASTType>> ASTTypes;
-typedef std::vector<std::unique_ptr<const ASTTypeApp>> ASTTypeApps;
-typedef std::vector<std::unique_ptr<const ASTTypeParam>> ASTTypeParams;
-typedef std::vector<std::unique_ptr<const FieldDecl>> FieldDecls;
-typedef std::vector<std::unique_ptr<const OptionDecl>> OptionDecls;
-typedef std::vector<std::unique_ptr<const FnDecl>> FnDecls;
-typedef std::vector<std::unique_ptr<const Param>> Params;
-typedef std::vector<std::unique_ptr<const Stmt>> Stmts;
+typedef ArenaVector<std::unique_ptr<const ASTType>> ASTTypes;
+typedef ArenaVector<std::unique_ptr<const ASTTypeApp>> ASTTypeApps;
+typedef ArenaVector<std::unique_ptr<const ASTTypeParam>> ASTTypeParams;
+typedef ArenaVector<std::unique_ptr<const FieldDecl>> FieldDecls;
+typedef ArenaVector<std::unique_ptr<const OptionDecl>> OptionDecls;
+typedef ArenaVector<std::unique_ptr<const FnDecl>> FnDecls;
+typedef ArenaVector<std::unique_ptr<const Param>> Params;
+typedef ArenaVector<std::unique_ptr<const Stmt>> Stmts;
 typedef std::vector<char> Chars;
 typedef thorin::HashMap<Symbol, const FieldDecl*> FieldTable;
 typedef thorin::HashMap<Symbol, const OptionDecl*> OptionTable;
@@ -139,8 +141,15 @@ public:
     Loc loc() const { return loc_; }
     virtual Stream& stream(Stream&) const = 0;
 
+    /// Number of @p ASTNode%s created so far - including the ones inserted by semantic analysis.
+    static size_t num_nodes() { return gid_counter_.load(std::memory_order_relaxed) - 1; }
+
+    /// @p ASTNode%s live in the current @p Arena; the memory is released all at once when the @p Arena dies.
+    static void* operator new(size_t size) { return Arena::alloc(size); }
+    static void operator delete(void*) {}
+
 private:
-    static size_t gid_counter_;
+    static std::atomic<size_t> gid_counter_;
 
     size_t gid_;
     Loc loc_;
@@ -211,7 +220,7 @@ public:
         friend class InferSema;
     };
 
-    typedef std::deque<std::unique_ptr<const Elem>> Elems;
+    typedef ArenaDeque<std::unique_ptr<const Elem>> Elems;
 
     Path(Loc loc, bool global, Elems&& elems)
         : Typeable(loc)
@@ -524,13 +533,17 @@ public:
     bool is_anonymous() const { assert(!is_no_decl()); return symbol() == Symbol() || symbol().c_str()[0] == '<'; }
     size_t depth() const { assert(!is_no_decl()); return depth_; }
     const Decl* shadows() const { assert(!is_no_decl()); return shadows_; }
-    thorin::Debug debug() const { return {symbol().c_str(), loc().filename(), loc().front_line(), loc().front_col(), loc().back_line(), loc().back_col()}; }
+    thorin::Debug debug() const {
+        auto l = loc().resolve();
+        return {symbol().c_str(), l.filename, l.front_line, l.front_col, l.back_line, l.back_col};
+    }
 
     // ValueDecl
     const ASTType* ast_type() const { assert(is_value_decl()); return ast_type_.get(); } ///< Original @p ASTType.
     bool is_mut() const { assert(is_value_decl()); return mut_; }
-    bool is_written() const { assert(is_value_decl()); return written_; }
-    void write() const { assert(is_value_decl()); written_ = true; }
+    bool is_written() const { assert(is_value_decl()); return written_.load(std::memory_order_relaxed); }
+    /// May be called concurrently: @p TypeSema checks several items at once, which may write the same global.
+    void write() const { assert(is_value_decl()); written_.store(true, std::memory_order_relaxed); }
     const thorin::Def* def() const { return def_; }
 
 private:
@@ -541,9 +554,9 @@ private:
 protected:
     mutable const thorin::Def* def_ = nullptr;
     mutable const Decl* shadows_;
-    mutable unsigned depth_   : 24;
-    unsigned mut_             :  1;
-    mutable unsigned written_ :  1;
+    mutable unsigned depth_ : 24;
+    unsigned mut_           :  1;
+    mutable std::atomic<bool> written_;
 
     friend class CodeGen;
     friend class NameSema;
@@ -573,6 +586,7 @@ private:
 protected:
     mutable const Fn* fn_;
     mutable bool is_address_taken_ = false;
+    mutable size_t ssa_index_ = size_t(-1); ///< Position in @p CodeGen::vars if this local is kept in SSA form.
 
     friend class CodeGen;
     friend class InferSema;
@@ -726,10 +740,17 @@ public:
         , items_(std::move(items))
     {}
 
-    Module(const char* first_file_name, Items&& items = Items())
-        : Module(items.empty() ? Loc(first_file_name, 1, 1) : Loc(items.front()->loc(), items.back()->loc()),
+    /// The top-level @p Module; it takes ownership of the @p Arena its @p items have been allocated from.
+    Module(const char* first_file_name, Items&& items = Items(), std::unique_ptr<Arena>&& arena = nullptr)
+        : Module(items.empty() ? Loc::file_start(first_file_name) : Loc(items.front()->loc(), items.back()->loc()),
                  Visibility::Pub, nullptr, ASTTypeParams(), std::move(items))
-    {}
+    {
+        arena_ = std::move(arena);
+    }
+
+    /// The top-level @p Module owns its @p Arena and, hence, must not live in it.
+    static void* operator new(size_t size) { return ::operator new(size); }
+    static void operator delete(void* ptr) { ::operator delete(ptr); }
 
     const Items& items() const { return items_; }
     const Symbol2Item& symbol2item() const { return symbol2item_; }
@@ -742,6 +763,7 @@ public:
     Stream& stream(Stream&) const override;
 
 private:
+    std::unique_ptr<Arena> arena_; ///< Declared before @p items_ so they are destroyed while their memory is still alive.
     Items items_;
     mutable Symbol2Item symbol2item_;
 };
@@ -977,7 +999,7 @@ public:
             t = lambda->body();
         return t->as<FnType>();
     }
-    Symbol fn_symbol() const override { return export_name_ != "" ? export_name_ : identifier()->symbol(); }
+    Symbol fn_symbol() const override { return !export_name_.empty() ? export_name_ : identifier()->symbol(); }
 
     void bind(NameSema&) const override;
     void emit_head(CodeGen&) const override;
@@ -1078,7 +1100,7 @@ public:
     virtual void bind(NameSema&) const = 0;
     virtual const thorin::Def* lemit(CodeGen&) const;
     virtual const thorin::Def* remit(CodeGen&) const;
-    virtual void emit_branch(CodeGen&, thorin::Lam*, thorin::Lam*) const;
+    virtual void emit_branch(CodeGen&, Join& jump_t, Join& jump_f) const;
 
 private:
     virtual const Type* infer(InferSema&) const = 0;
@@ -1088,7 +1110,7 @@ protected:
     /**
      * A back reference to the @p std::unique_ptr which owns this @p Expr.
      * This means that the address is @em not supposed to be changed in the future.
-     * For this reason, @p Exprs is a <tt> std::deque<std::unique_ptr<const Expr>> </tt> and @em not a @c std::vector.
+     * For this reason, @p Exprs is an <tt> ArenaDeque<std::unique_ptr<const Expr>> </tt> and @em not a @c std::vector.
      */
     mutable std::unique_ptr<const Expr>* back_ref_ = nullptr;
 
@@ -1193,13 +1215,13 @@ private:
 
 class CharExpr : public Expr {
 public:
-    CharExpr(Loc loc, Symbol symbol, char value)
+    CharExpr(Loc loc, std::string&& spelling, char value)
         : Expr(loc)
-        , symbol_(symbol)
+        , spelling_(std::move(spelling))
         , value_(value)
     {}
 
-    Symbol symbol() const { return symbol_; }
+    const std::string& spelling() const { return spelling_; }
     char value() const { return value_; }
 
     void bind(NameSema&) const override;
@@ -1210,19 +1232,19 @@ private:
     const Type* infer(InferSema&) const override;
     void check(TypeSema&) const override;
 
-    Symbol symbol_;
+    std::string spelling_;
     char value_;
 };
 
 class StrExpr : public Expr {
 public:
-    StrExpr(Loc loc, Symbols&& symbols, std::vector<char>&& values)
+    StrExpr(Loc loc, Strings&& spellings, std::vector<char>&& values)
         : Expr(loc)
-        , symbols_(std::move(symbols))
+        , spellings_(std::move(spellings))
         , values_(std::move(values))
     {}
 
-    const Symbols& symbols() const { return symbols_; }
+    const Strings& spellings() const { return spellings_; }
     const std::vector<char>& values() const { return values_; }
 
     void bind(NameSema&) const override;
@@ -1233,7 +1255,7 @@ private:
     const Type* infer(InferSema&) const override;
     void check(TypeSema&) const override;
 
-    Symbols symbols_;
+    Strings spellings_;
     mutable std::vector<char> values_;
 };
 
@@ -1245,7 +1267,7 @@ public:
     {}
 
     const FnType* fn_type() const override { return type()->as<FnType>(); }
-    Symbol fn_symbol() const override { return Symbol("lambda"); }
+    Symbol fn_symbol() const override { return syms::lambda; }
     void bind(NameSema&) const override;
     const thorin::Def* remit(CodeGen&) const override;
     Stream& stream(Stream&) const override;
@@ -1344,7 +1366,7 @@ public:
     bool has_side_effect() const override;
     void bind(NameSema&) const override;
     const thorin::Def* remit(CodeGen&) const override;
-    void emit_branch(CodeGen&, thorin::Lam*, thorin::Lam*) const override;
+    void emit_branch(CodeGen&, Join& jump_t, Join& jump_f) const override;
     Stream& stream(Stream&) const override;
 
 private:
@@ -1600,7 +1622,7 @@ public:
         friend class StructExpr;
     };
 
-    typedef std::deque<std::unique_ptr<const Elem>> Elems;
+    typedef ArenaDeque<std::unique_ptr<const Elem>> Elems;
 
     StructExpr(Loc loc, const ASTTypeApp* ast_type_app, Elems&& elems)
         : Expr(loc)
@@ -1688,12 +1710,28 @@ private:
     friend class CodeGen;
 };
 
+/**
+ * Arithmetic attributes - like <tt>#[fast_math]</tt> - of a @p BlockExpr or a function body.
+ * They adjust the @c RMode of all floating-point operations and the @c WMode of unsigned integer operations within.
+ */
+struct ArithAttrs {
+    thorin::nat_t rmode = thorin::RMode::none; ///< Flags to add.
+    bool strict = false;                        ///< <tt>#[fp_strict]</tt>: drop the flags of the surrounding code first.
+    bool nuw    = false;                        ///< <tt>#[no_unsigned_wrap]</tt>: unsigned arithmetic does not wrap.
+    bool wrap   = false;                        ///< <tt>#[unsigned_wrap]</tt>: unsigned arithmetic wraps again.
+
+    bool empty() const { return rmode == thorin::RMode::none && !strict && !nuw && !wrap; }
+    thorin::nat_t apply_rmode(thorin::nat_t outer) const { return (strict ? thorin::nat_t(thorin::RMode::none) : outer) | rmode; }
+    bool apply_nuw(bool outer) const { return !wrap && (outer || nuw); }
+};
+
 class BlockExpr : public Expr {
 public:
-    BlockExpr(Loc loc, Stmts&& stmts, const Expr* expr)
+    BlockExpr(Loc loc, Stmts&& stmts, const Expr* expr, ArithAttrs arith_attrs = {})
         : Expr(loc)
         , stmts_(std::move(stmts))
         , expr_(dock(expr_, expr))
+        , arith_attrs_(arith_attrs)
     {}
     /// An empty BlockExpr with no @p stmts and an @p EmptyExpr as @p expr.
     BlockExpr(Loc loc)
@@ -1704,6 +1742,7 @@ public:
     const Expr* expr() const { return expr_.get(); }
     const Stmt* stmt(size_t i) const { return stmts_[i].get(); }
     bool empty() const { return stmts_.empty() && expr_->isa<EmptyExpr>(); }
+    const ArithAttrs& arith_attrs() const { return arith_attrs_; }
     const LocalDecls& locals() const { return locals_; }
     void add_local(const LocalDecl* local) const { locals_.push_back(local); }
 
@@ -1711,6 +1750,7 @@ public:
     void bind(NameSema&) const override;
     const thorin::Def* remit(CodeGen&) const override;
     Stream& stream(Stream&) const override;
+    Stream& stream_block(Stream&) const; ///< Like @p stream but without the @p arith_attrs - a @p FnDecl puts them in front.
 
 protected:
     const Type* infer(InferSema&) const override;
@@ -1718,6 +1758,7 @@ protected:
 
     Stmts stmts_;
     std::unique_ptr<const Expr> expr_;
+    ArithAttrs arith_attrs_;
     mutable LocalDecls locals_; ///< All @p LocalDecl%s in this @p BlockExpr from top to bottom.
 };
 
@@ -1768,7 +1809,7 @@ public:
         std::unique_ptr<const Expr> expr_;
     };
 
-    typedef std::deque<std::unique_ptr<const Arm>> Arms;
+    typedef ArenaDeque<std::unique_ptr<const Arm>> Arms;
 
     MatchExpr(Loc loc, const Expr* expr, Arms&& arms)
         : Expr(loc)
@@ -1809,6 +1850,8 @@ public:
     const BlockExpr* body() const { return body_.get()->as<BlockExpr>(); }
     const LocalDecl* break_decl() const { return break_decl_.get(); }
     const LocalDecl* continue_decl() const { return continue_decl_.get(); }
+    /// Mutable locals of the enclosing function which are written within @p cond or @p body.
+    const LocalDecls& written_locals() const { return written_locals_; }
 
     bool has_side_effect() const override;
     void bind(NameSema&) const override;
@@ -1823,6 +1866,10 @@ private:
     std::unique_ptr<const Expr> cond_;
     std::unique_ptr<const Expr> body_;
     std::unique_ptr<const LocalDecl> break_decl_;
+    mutable LocalDecls written_locals_;
+    mutable bool escapes_ = false; ///< @p break_decl or @p continue_decl is used other than by a direct call.
+
+    friend class TypeSema;
 };
 
 class ForExpr : public Expr {
@@ -2124,7 +2171,7 @@ public:
         std::unique_ptr<const Expr> expr_;
     };
 
-    typedef std::deque<std::unique_ptr<const Elem>> Elems;
+    typedef ArenaDeque<std::unique_ptr<const Elem>> Elems;
 
     AsmStmt(Loc loc, std::string&& asm_template, Elems&& outputs, Elems&& inputs,
             Strings&& clobbers, Strings&& options)
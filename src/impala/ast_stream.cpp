@@ -124,7 +124,25 @@ Stream& ExternBlock::stream(Stream& s) const {
     return s.fmt("extern {}{{\t\n{\n}\b\n}}", abi_.empty() ? std::string() : abi_.str() + " ", fn_decls());
 }
 
+static Stream& stream_arith_attrs(Stream& s, const ArithAttrs& arith_attrs) {
+    if (arith_attrs.empty()) return s;
+    std::vector<const char*> names;
+    if (arith_attrs.strict) names.push_back("fp_strict");
+    if ((arith_attrs.rmode & RMode::fast) == RMode::fast) {
+        names.push_back("fast_math");
+    } else {
+        if (arith_attrs.rmode & RMode::contract) names.push_back("fp_contract");
+        if (arith_attrs.rmode & RMode::nsz)      names.push_back("no_signed_zeros");
+        if (arith_attrs.rmode & RMode::arcp)     names.push_back("reciprocal_math");
+    }
+    if (arith_attrs.nuw)  names.push_back("no_unsigned_wrap");
+    if (arith_attrs.wrap) names.push_back("unsigned_wrap");
+    return s.fmt("#[{, }] ", names);
+}
+
 Stream& FnDecl::stream(Stream& s) const {
+    auto block = body() ? body()->isa<BlockExpr>() : nullptr;
+    if (block) stream_arith_attrs(s, block->arith_attrs());
     s.fmt("{}fn", is_extern() ? "extern " : "");
     if (filter()) s.fmt(" @{} ", filter());
 
@@ -132,7 +150,7 @@ Stream& FnDecl::stream(Stream& s) const {
     stream_ast_type_params(s);
 
     const FnASTType* ret = nullptr;
-    if (!params().empty() && params().back()->symbol() == "return" && params().back()->ast_type()) {
+    if (!params().empty() && params().back()->symbol() == syms::ret && params().back()->ast_type()) {
         if (auto fn_type = params().back()->ast_type()->isa<FnASTType>())
             ret = fn_type;
     }
@@ -147,6 +165,8 @@ Stream& FnDecl::stream(Stream& s) const {
             s.fmt("({, })", ret->ast_type_args());
     }
 
+    if (block)
+        return block->stream_block(s << ' ');
     if (body())
         return s << ' ' << body();
     return s << ';';
@@ -210,7 +230,9 @@ Stream& ImplItem::stream(Stream& s) const {
  * expressions
  */
 
-Stream& BlockExpr::stream(Stream& s) const {
+Stream& BlockExpr::stream(Stream& s) const { return stream_block(stream_arith_attrs(s, arith_attrs())); }
+
+Stream& BlockExpr::stream_block(Stream& s) const {
     s << '{';
     if (empty()) return s.endl() << '}';
 
@@ -243,13 +265,17 @@ Stream& LiteralExpr::stream(Stream& s) const {
 }
 
 Stream& CharExpr::stream(Stream& s) const {
-    return s << symbol();
+    return s << spelling();
 }
 
 Stream& StrExpr::stream(Stream& s) const {
-    if (symbols().size() == 1)
-        return s << '\'' << symbols().front().remove_quotation() << '\'';
-    return s.fmt("\t\n{\n}\b\n", symbols());
+    if (spellings().size() == 1) {
+        auto str = spellings().front();
+        if (!str.empty() && str.front() == '"')
+            str = str.substr(1, str.size() - (str.size() >= 2 && str.back() == '"' ? 2 : 1));
+        return s << '\'' << str << '\'';
+    }
+    return s.fmt("\t\n{\n}\b\n", spellings());
 }
 
 Stream& PathExpr ::stream(Stream& s) const { return s << path(); }
@@ -387,7 +413,7 @@ Stream& MapExpr::stream(Stream& s) const {
 }
 
 Stream& FnExpr::stream(Stream& s) const {
-    bool has_return_type = !params().empty() && params().back()->symbol() == "return";
+    bool has_return_type = !params().empty() && params().back()->symbol() == syms::ret;
     s << '|';
     stream_params(s, has_return_type);
     s << "| ";
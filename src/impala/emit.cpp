@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <numeric>
+
 #include "impala/ast.h"
+#include "impala/trace.h"
 
 #include "thorin/util.h"
 #include "thorin/world.h"
@@ -8,22 +12,73 @@ using namespace thorin;
 
 namespace impala {
 
+/**
+ * A basic block which may be reached from several predecessors.
+ * Its @p Lam is not created before @p CodeGen::enter when all @p CodeGen::jump%s to it are known.
+ * In terms of Braun et al.'s on-the-fly SSA construction, the block is sealed at this point: each local in SSA form
+ * whose values differ among the predecessors becomes a parameter while trivial phis do not even come into existence.
+ */
+class Join {
+public:
+    /// @p type is the type of the value passed along with each jump or @c nullptr.
+    Join(const thorin::Def* type, Debug dbg)
+        : type_(type)
+        , dbg_(dbg)
+    {}
+
+private:
+    struct Jump {
+        Lam* bb;
+        const Def* mem;
+        const Def* val;
+        std::vector<const Def*> vars;
+        Debug dbg;
+    };
+
+    const thorin::Def* type_;
+    Debug dbg_;
+    std::vector<Jump> jumps_;
+
+    friend class CodeGen;
+};
+
+static flags_t type2wmode(const Type* type) {
+    return is_bool(type) ? WMode::nuw : (is_signed(type) ? WMode::nsw : WMode::none);
+}
+
 class CodeGen {
 public:
-    CodeGen(World& world)
+    CodeGen(World& world, const EmitOptions& options)
         : world(world)
+        , options(options)
+        , rmode(options.rmode)
+        , nuw(options.nuw)
     {}
 
-    Debug loc2dbg(Loc loc) { return {loc.filename(), loc.front_line(), loc.front_col(), loc.back_line(), loc.back_col()}; }
-    Debug loc2dbg(const char* s, Loc loc) { return {s, loc.filename(), loc.front_line(), loc.front_col(), loc.back_line(), loc.back_col()}; }
+    Debug loc2dbg(Loc loc) {
+        auto l = loc.resolve();
+        return {l.filename, l.front_line, l.front_col, l.back_line, l.back_col};
+    }
+    Debug loc2dbg(const char* s, Loc loc) {
+        auto l = loc.resolve();
+        return {s, l.filename, l.front_line, l.front_col, l.back_line, l.back_col};
+    }
 
-    /// Lam of type { @c cn(mem) } or { @c cn(mem, type) } depending on whether @p type is @c nullptr.
-    Lam* basicblock(const thorin::Def* type, Debug dbg) {
-        auto cn = type ? world.cn({world.type_mem(), type}) : world.cn(world.type_mem());
-        auto bb = world.lam(cn, Lam::CC::C, Lam::Intrinsic::None, dbg);
+    /// Lam of type { @c cn(mem, types...) }.
+    Lam* basicblock(Defs types, Debug dbg) {
+        std::vector<const thorin::Def*> params;
+        params.push_back(world.type_mem());
+        params.insert(params.end(), types.begin(), types.end());
+        auto bb = world.lam(world.cn(params), Lam::CC::C, Lam::Intrinsic::None, dbg);
         bb->param(0, {"mem"});
         return bb;
     }
+    /// Lam of type { @c cn(mem) } or { @c cn(mem, type) } depending on whether @p type is @c nullptr.
+    Lam* basicblock(const thorin::Def* type, Debug dbg) {
+        std::vector<const thorin::Def*> types;
+        if (type) types.push_back(type);
+        return basicblock(types, dbg);
+    }
     Lam* basicblock(Debug dbg) { return basicblock(nullptr, dbg); }
 
     Lam* enter(Lam* bb) {
@@ -32,6 +87,67 @@ public:
         return bb;
     }
 
+    /// Enters @p bb whose parameters after @c mem are the new values of the @p carried locals.
+    Lam* enter(Lam* bb, const LocalDecls& carried) {
+        enter(bb);
+        for (size_t i = 0, e = carried.size(); i != e; ++i)
+            write(carried[i], bb->param(i + 1));
+        return bb;
+    }
+
+    /// Creates @p join's @p Lam and enters it.
+    Lam* enter(Join& join) {
+        auto& jumps = join.jumps_;
+
+        // a local only becomes a parameter if its values differ; locals declared in between are out of scope
+        size_t num_vars = jumps.empty() ? vars.size() : size_t(-1);
+        for (auto&& jump : jumps)
+            num_vars = std::min(num_vars, jump.vars.size());
+
+        std::vector<size_t> phis;
+        for (size_t i = 0; i != num_vars && !jumps.empty(); ++i) {
+            auto var = jumps.front().vars[i];
+            if (std::any_of(jumps.begin() + 1, jumps.end(), [&](const Join::Jump& jump) { return jump.vars[i] != var; }))
+                phis.push_back(i);
+        }
+
+        std::vector<const thorin::Def*> types;
+        if (join.type_) types.push_back(join.type_);
+        for (auto i : phis) types.push_back(jumps.front().vars[i]->type());
+        auto bb = basicblock(types, join.dbg_);
+
+        for (auto&& jump : jumps) {
+            std::vector<const Def*> args;
+            args.push_back(jump.mem);
+            if (jump.val) args.push_back(jump.val);
+            for (auto i : phis) args.push_back(jump.vars[i]);
+            jump.bb->app(bb, args, jump.dbg);
+        }
+
+        enter(bb);
+        if (!jumps.empty()) {
+            vars = std::move(jumps.front().vars);
+            vars.resize(num_vars);
+        }
+        size_t p = join.type_ ? 2 : 1;
+        for (auto i : phis)
+            vars[i] = bb->param(p++);
+        return bb;
+    }
+
+    /// Leaves @p cur_bb towards @p join - possibly passing @p val.
+    void jump(Join& join, const Def* val, Debug dbg) { join.jumps_.push_back({cur_bb, cur_mem, val, vars, dbg}); }
+    void jump(Join& join, Debug dbg) { jump(join, nullptr, dbg); }
+
+    /// Leaves @p cur_bb towards @p bb passing the current values of the @p carried locals.
+    void jump(Lam* bb, const LocalDecls& carried, Debug dbg) {
+        std::vector<const Def*> args;
+        args.push_back(cur_mem);
+        for (auto local : carried)
+            args.push_back(read(local));
+        cur_bb->app(bb, args, dbg);
+    }
+
     const Def* lit_one(const Type* type, Debug dbg) {
         if (is_int(type)) return world.lit(convert(type), 1, dbg);
         switch (type->tag()) {
@@ -42,6 +158,103 @@ public:
         }
     }
 
+    /*
+     * integer arithmetic
+     */
+
+    /// Like @p type2wmode but unsigned arithmetic - except for shifts - does not wrap within <tt>#[no_unsigned_wrap]</tt>.
+    flags_t wmode(WOp op, const Type* type) {
+        if (nuw && op != WOp::shl && is_int(type) && !is_signed(type)) return WMode::nuw;
+        return type2wmode(type);
+    }
+
+    /// The external C function @c abort which is called on overflows with @p EmitOptions::check_overflow.
+    Lam* trap() {
+        if (trap_ == nullptr) {
+            trap_ = world.lam(world.cn(world.type_mem()), Lam::CC::C, Lam::Intrinsic::None, {"abort"});
+            trap_->make_external();
+        }
+        return trap_;
+    }
+
+    /// Continues in a new basic block if @p ok holds and aborts otherwise.
+    void trap_unless(const Def* ok, Debug dbg) {
+        auto next = basicblock(dbg);
+        auto fail = basicblock(dbg);
+        cur_bb->branch(ok, next, fail, cur_mem, dbg);
+        fail->app(trap(), {fail->param(0)}, dbg);
+        enter(next);
+    }
+
+    /**
+     * Emits @p a @p op @p b of integer @p type with the @p wmode in effect.
+     * With @p EmitOptions::check_overflow, the program aborts instead if the result wraps although the @c WMode claims
+     * it does not:
+     * - a sum or difference must have the sign - or unsigned: the order - its operands imply,
+     * - a product of up to 32 bits must match the exact one computed with twice the bits; a 64 bit product must divide
+     *   back into its operand as there is no wider type,
+     * - a shift must not exceed the bits and must be undone by shifting back.
+     * Constant operands - in particular all of a static initializer, which is not emitted into any basic block - are
+     * folded without a check.
+     */
+    const Def* arith(WOp op, const Type* type, const Def* a, const Def* b, Debug dbg) {
+        auto mode = wmode(op, type);
+        if (!options.check_overflow || mode == WMode::none || !is_int(type) || cur_bb == nullptr
+                || (a->is_const() && b->is_const()))
+            return world.op(op, mode, a, b, dbg);
+
+        bool s = is_signed(type);
+        auto bits = layout(type).size * 8;
+        auto t = convert(type);
+        auto zero = world.lit(t, 0, dbg);
+        auto res = world.op(op, WMode::none, a, b, dbg);
+        auto both = [&](const Def* x, const Def* y) { return world.extract(Bit::_and, x, y, dbg); };
+        auto either = [&](const Def* x, const Def* y) { return world.extract(Bit::_or, x, y, dbg); };
+        auto select = [&](const Def* cond, const Def* then, const Def* otherwise) { return world.extract(world.tuple({otherwise, then}), cond, dbg); };
+
+        const Def* ok = nullptr;
+        switch (op) {
+            case WOp::add:
+                // signed: a sum has the sign of both operands if they agree; unsigned: it is at least as large as each one
+                ok = s ? world.op(World::Cmp::ge, world.op(Bit::_and, world.op(Bit::_xor, res, a, dbg), world.op(Bit::_xor, res, b, dbg), dbg), zero, dbg)
+                       : world.op(World::Cmp::ge, res, a, dbg);
+                break;
+            case WOp::sub:
+                // signed: a difference of operands with different signs has the sign of @p a; unsigned: @p b must not exceed @p a
+                ok = s ? world.op(World::Cmp::ge, world.op(Bit::_and, world.op(Bit::_xor, a, b, dbg), world.op(Bit::_xor, a, res, dbg), dbg), zero, dbg)
+                       : world.op(World::Cmp::ge, a, b, dbg);
+                break;
+            case WOp::mul:
+                if (bits <= 32) {
+                    auto wide = s ? world.type_sint(2 * bits) : world.type_int(2 * bits);
+                    auto conv = s ? Conv::s2s : Conv::u2u;
+                    auto exact = world.op(op, WMode::none, world.op(conv, wide, a, dbg), world.op(conv, wide, b, dbg), dbg);
+                    ok = world.op(World::Cmp::eq, world.op(conv, wide, res, dbg), exact, dbg);
+                } else {
+                    // res / a == b unless a is 0; signed, -1 * MIN is the only product whose quotient traps itself
+                    auto one = world.lit(t, 1, dbg);
+                    auto a_zero = world.op(World::Cmp::eq, a, zero, dbg);
+                    auto a_minus_one = s ? world.op(World::Cmp::eq, a, world.lit(t, u64(-1), dbg), dbg) : world.lit_false();
+                    auto divisor = select(either(a_zero, a_minus_one), one, a);
+                    auto quotient = handle_mem_res(world.op(s ? ZOp::sdiv : ZOp::udiv, cur_mem, res, divisor, dbg));
+                    auto b_not_min = world.op(World::Cmp::ne, b, world.lit(t, u64(1) << (bits - 1), dbg), dbg);
+                    ok = select(a_zero, world.lit_true(),
+                         select(a_minus_one, b_not_min, world.op(World::Cmp::eq, quotient, b, dbg)));
+                }
+                break;
+            case WOp::shl: {
+                auto in_range = world.op(World::Cmp::lt, b, world.lit(t, bits, dbg), dbg);
+                if (s) in_range = both(world.op(World::Cmp::ge, b, zero, dbg), in_range);
+                ok = both(in_range, world.op(World::Cmp::eq, world.op(s ? Shr::a : Shr::l, res, b, dbg), a, dbg));
+                break;
+            }
+            default: THORIN_UNREACHABLE;
+        }
+
+        trap_unless(ok, dbg);
+        return res;
+    }
+
     std::pair<Lam*, const Def*> call(const Def* callee, Defs args, const thorin::Def* ret_type, Debug dbg) {
         if (ret_type == nullptr) {
             cur_bb->app(callee, args, dbg);
@@ -90,6 +303,74 @@ public:
         return result;
     }
 
+    /// Like above for a @c break or @c continue of a @p WhileExpr which additionally receives the @p carried locals.
+    Lam* create_lam(const LocalDecl* decl, const LocalDecls& carried) {
+        if (carried.empty()) return create_lam(decl);
+        assert(decl->type()->as<FnType>()->num_params() == 0);
+        std::vector<const thorin::Def*> types;
+        for (auto local : carried)
+            types.push_back(convert(local->type()));
+        auto result = basicblock(types, decl->debug());
+        decl->def_ = result;
+        return result;
+    }
+
+    /*
+     * mutable locals in SSA form
+     */
+
+    /// Mutable locals of primitive type are kept in SSA form unless their address is taken.
+    bool is_ssa(const LocalDecl* local) const {
+        return options.ssa && local->is_mut() && !local->is_address_taken_ && local->type()->isa<PrimType>();
+    }
+
+    const Def* read(const LocalDecl* local) { return vars[local->ssa_index_]; }
+    void write(const LocalDecl* local, const Def* def) { vars[local->ssa_index_] = def; }
+
+    /// Those of the @p written locals of a @p WhileExpr which are in SSA form and already declared before the loop.
+    LocalDecls carried(const LocalDecls& written) {
+        LocalDecls result;
+        for (auto local : written) {
+            if (is_ssa(local) && local->ssa_index_ < vars.size())
+                result.push_back(local);
+        }
+        return result;
+    }
+
+    /// The carried locals if @p callee is the @c break or @c continue of a @p WhileExpr being emitted.
+    const LocalDecls* continuation(const Expr* callee) {
+        if (auto path = callee->skip_rvalue()->isa<PathExpr>()) {
+            for (auto&& [loop, locals] : loops) {
+                if (path->value_decl() == loop->break_decl() || path->value_decl() == loop->continue_decl())
+                    return &locals;
+            }
+        }
+        return nullptr;
+    }
+
+    /// Either a pointer or - for a local in SSA form - the @p LocalDecl itself.
+    struct LValue {
+        const LocalDecl* local;
+        const Def* ptr;
+    };
+
+    LValue lemit(const Expr* expr) {
+        if (auto path = expr->isa<PathExpr>()) {
+            if (auto local = path->value_decl()->isa<LocalDecl>(); local && is_ssa(local))
+                return {local, nullptr};
+        }
+        return {nullptr, expr->lemit(*this)};
+    }
+
+    const Def* load(LValue lvalue, Loc loc) { return lvalue.local ? read(lvalue.local) : load(lvalue.ptr, loc); }
+
+    void store(LValue lvalue, const Def* val, Loc loc) {
+        if (lvalue.local)
+            write(lvalue.local, val);
+        else
+            store(lvalue.ptr, val, loc);
+    }
+
     const Def* handle_mem_res(const Def* mem_res) {
         auto [mem, res] = mem_res->split<2>();
         cur_mem = mem;
@@ -112,6 +393,141 @@ public:
         return result;
     }
 
+    /*
+     * enum layout
+     */
+
+    /// Size and alignment in bytes of a value on a 64-bit target.
+    struct Layout {
+        u64 size  = 0;
+        u64 align = 1;
+
+        /// Appends a field of @p layout like a C struct does.
+        void append(Layout layout) {
+            size = round_up(size, layout.align) + layout.size;
+            align = std::max(align, layout.align);
+        }
+
+        Layout& finish() { size = round_up(size, align); return *this; }
+
+        static u64 round_up(u64 n, u64 align) { return (n + align - 1) / align * align; }
+    };
+
+    /**
+     * How the values of an enum are represented in Thorin:
+     * - a simple enum is just its tag,
+     * - any other enum is a sigma of the storage shared by all payloads followed by the tag.
+     * No pointer type is guaranteed to be non-null - <tt>0 as ~T</tt> is fine - so there is no null pointer niche.
+     * The tag is the smallest integer which fits all options.
+     * It directly follows the largest payload - which is not rounded up to its alignment - so it may occupy what would
+     * be the payload's tail padding otherwise.
+     */
+    struct EnumLayout {
+        const thorin::Def* tag_type = nullptr;
+        const thorin::Def* storage = nullptr; ///< The sigma of payload and tag; @c nullptr for simple enums.
+        Layout layout;
+    };
+
+    Layout layout(const Type* type) {
+        if (auto prim_type = type->isa<PrimType>()) {
+            switch (prim_type->primtype_tag()) {
+                case PrimType_bool: case PrimType_i8:  case PrimType_u8:  return {1, 1};
+                case PrimType_i16:  case PrimType_u16: case PrimType_f16: return {2, 2};
+                case PrimType_i32:  case PrimType_u32: case PrimType_f32: return {4, 4};
+                case PrimType_i64:  case PrimType_u64: case PrimType_f64: return {8, 8};
+                default: THORIN_UNREACHABLE;
+            }
+        } else if (type->isa<PtrType>() || type->isa<FnType>()) {
+            return {8, 8};
+        } else if (type->isa<TupleType>() || type->isa<StructType>()) {
+            Layout result;
+            for (auto&& op : type->ops())
+                result.append(layout(op));
+            return result.finish();
+        } else if (auto definite_array_type = type->isa<DefiniteArrayType>()) {
+            auto elem = layout(definite_array_type->elem_type());
+            return {definite_array_type->dim() * elem.size, elem.align};
+        } else if (auto simd_type = type->isa<SimdType>()) {
+            // vectors are aligned to their size rounded up to a power of two
+            auto size = simd_type->dim() * layout(simd_type->elem_type()).size;
+            u64 align = 1;
+            while (align < size) align *= 2;
+            return {align, align};
+        } else if (auto enum_type = type->isa<EnumType>()) {
+            return enum_layout(enum_type).layout;
+        }
+        // neither indefinite arrays nor type variables of generic enums have a size
+        THORIN_UNREACHABLE;
+    }
+
+    /// Indices of the arguments of @p option in the order they are stored in the payload - by decreasing alignment.
+    std::vector<size_t> payload_order(const OptionDecl* option) {
+        std::vector<size_t> order(option->num_args());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return layout(option->arg(a)->type()).align > layout(option->arg(b)->type()).align;
+        });
+        return order;
+    }
+
+    EnumLayout enum_layout(const EnumType* enum_type) {
+        if (auto i = enum_layouts_.find(enum_type); i != enum_layouts_.end())
+            return i->second;
+
+        EnumLayout result;
+        auto enum_decl = enum_type->enum_decl();
+        auto num_options = enum_decl->num_option_decls();
+        u64 tag_size = num_options <= 0x100 ? 1 : num_options <= 0x10000 ? 2 : 4;
+        result.tag_type = world.type_int(tag_size * 8);
+        result.layout = {tag_size, tag_size};
+
+        if (!enum_decl->is_simple()) {
+            // the largest payload without its tail padding
+            Layout payload;
+            for (auto&& option : enum_decl->option_decls()) {
+                Layout variant;
+                for (auto i : payload_order(option.get()))
+                    variant.append(layout(option->arg(i)->type()));
+                payload.size  = std::max(payload.size,  variant.size);
+                payload.align = std::max(payload.align, variant.align);
+            }
+
+            // whole words of the payload's alignment and the remaining bytes keep the tag from being padded
+            std::vector<const thorin::Def*> fields;
+            fields.push_back(world.arr(payload.size / payload.align, world.type_int(payload.align * 8)));
+            if (auto rest = payload.size % payload.align)
+                fields.push_back(world.arr(rest, world.type_int(8)));
+            fields.push_back(result.tag_type);
+            result.storage = world.sigma(fields);
+
+            result.layout = payload;
+            result.layout.append({tag_size, tag_size});
+            result.layout.finish();
+        }
+
+        return enum_layouts_[enum_type] = result;
+    }
+
+    /// Stores @p def in a stack slot of type @p storage and loads it back as @p type - Thorin has no unions.
+    /// The slot must be at least as large as @p type.
+    const Def* reinterpret(const Def* storage, const Def* def, const Def* type, Debug dbg) {
+        auto ptr = slot(storage, dbg);
+        cur_mem = world.op_store(cur_mem, world.op_bitcast(world.type_ptr(def->type()), ptr, dbg), def, dbg);
+        return handle_mem_res(world.op_load(cur_mem, world.op_bitcast(world.type_ptr(type), ptr, dbg), dbg));
+    }
+
+    /// The tag of the enum value @p def as an integer of @p EnumLayout::tag_type - that is the index of its option.
+    const Def* enum_tag(const EnumType* enum_type, const Def* def, Debug dbg) {
+        auto enum_layout = this->enum_layout(enum_type);
+        return enum_layout.storage ? world.extract(def, enum_layout.storage->num_ops() - 1, dbg) : def;
+    }
+
+    /// The arguments of @p option stored in the enum value @p def in the order of @p payload_order.
+    const Def* enum_variant(const OptionDecl* option, const Def* def, Debug dbg) {
+        auto storage = enum_layout(option->enum_decl()->enum_type()).storage;
+        return reinterpret(storage, def, option->variant_type(*this), dbg);
+    }
+
     const thorin::Def *rev_diff(const thorin::Def *primal) { return world.op_rev_diff(primal); }
 
     const thorin::Def* convert(const Type* type) {
@@ -125,15 +541,20 @@ public:
 
     const thorin::Def*& thorin_type(const Type* type) { return impala2thorin_[type]; }
     const thorin::Sigma*& thorin_struct_type(const StructType* type) { return struct_type_impala2thorin_[type]; }
-    const thorin::Sigma*& thorin_enum_type(const EnumType* type) { return enum_type_impala2thorin_[type]; }
 
     World& world;
+    const EmitOptions options;
+    nat_t rmode; ///< Of floating-point operations in the current @p BlockExpr.
+    bool nuw;    ///< Whether unsigned arithmetic in the current @p BlockExpr does not wrap.
     const Fn* cur_fn = nullptr;
     TypeMap<const thorin::Def*> impala2thorin_;
     GIDMap<const StructType*, const thorin::Sigma*> struct_type_impala2thorin_;
-    GIDMap<const EnumType*,   const thorin::Sigma*> enum_type_impala2thorin_;
+    GIDMap<const EnumType*,   EnumLayout> enum_layouts_;
     Lam* cur_bb = nullptr;
     const Def* cur_mem = nullptr;
+    std::vector<const Def*> vars; ///< Current value of each local in SSA form of @p cur_fn.
+    std::vector<std::pair<const WhileExpr*, LocalDecls>> loops; ///< Enclosing loops with their carried locals.
+    Lam* trap_ = nullptr;
 };
 
 /*
@@ -179,24 +600,11 @@ const thorin::Def* CodeGen::convert_rec(const Type* type) {
             s->set(i++, convert(op));
         thorin_type(type) = nullptr; // will be set again by CodeGen's wrapper
         return s;
-#if 0
     } else if (auto enum_type = type->isa<EnumType>()) {
-        auto s = world.sigma(2, {enum_type->enum_decl()->symbol().c_str()});
-        thorin_enum_type(enum_type) = s;
-        thorin_type(enum_type) = s;
-
-        auto enum_decl = enum_type->enum_decl();
-        thorin::DefSet variants;
-        for (auto&& option : enum_decl->option_decls())
-            variants.insert(option->variant_type(*this));
-        thorin::Array<const thorin::Def*> ops(variants.size());
-        std::copy(variants.begin(), variants.end(), ops.begin());
-
-        s->set(0, world.type_int(32));
-        s->set(1, world.variant_type(ops));
-        thorin_type(enum_type) = nullptr;
-        return s;
-#endif
+        auto enum_layout = this->enum_layout(enum_type);
+        if (enum_layout.storage)
+            return enum_layout.storage;
+        return enum_layout.tag_type;
     } else if (auto ptr = type->isa<PtrType>()) {
         return world.type_ptr(convert(ptr->pointee()), ptr->addr_space());
     } else if (auto definite_array_type = type->isa<DefiniteArrayType>()) {
@@ -219,7 +627,10 @@ void LocalDecl::emit(CodeGen& cg, const Def* init) const {
     auto thorin_type = cg.convert(type());
     init = init ? init : cg.world.bot(thorin_type);
 
-    if (is_mut()) {
+    if (cg.is_ssa(this)) {
+        ssa_index_ = cg.vars.size();
+        cg.vars.push_back(init);
+    } else if (is_mut()) {
         def_ = cg.slot(thorin_type, debug());
         cg.cur_mem = cg.world.op_store(cg.cur_mem, def_, init, cg.loc2dbg(loc()));
     } else {
@@ -229,8 +640,8 @@ void LocalDecl::emit(CodeGen& cg, const Def* init) const {
 
 const thorin::Def* OptionDecl::variant_type(CodeGen& cg) const {
     std::vector<const thorin::Def*> types;
-    for (auto&& arg : args())
-        types.push_back(cg.convert(arg->type()));
+    for (auto i : cg.payload_order(this))
+        types.push_back(cg.convert(arg(i)->type()));
     if (num_args() == 1) return types.back();
     return cg.world.sigma(types);
 }
@@ -245,6 +656,8 @@ void Fn::fn_emit_body(CodeGen& cg, Loc loc) const {
     THORIN_PUSH(cg.cur_fn, this);
     THORIN_PUSH(cg.cur_bb, lam());
     auto old_mem = cg.cur_mem;
+    std::vector<const Def*> old_vars;
+    std::swap(old_vars, cg.vars);
 
     // setup memory
     size_t i = 0;
@@ -276,6 +689,7 @@ void Fn::fn_emit_body(CodeGen& cg, Loc loc) const {
 
     lam()->set_filter(filter() ? filter()->remit(cg) : cg.world.lit_false());
     cg.cur_mem = old_mem;
+    std::swap(old_vars, cg.vars);
 }
 
 /*
@@ -288,44 +702,41 @@ void Module::emit(CodeGen& cg) const {
 }
 
 static bool is_primop(const Symbol& name) {
-    if      (name == "select")   return true;
-    else if (name == "sizeof")   return true;
-    else if (name == "bitcast")  return true;
-    else if (name == "insert")   return true;
-    else if (name == "rev_diff") return true;
-    return false;
+    return name == syms::select || name == syms::size_of || name == syms::bitcast || name == syms::insert || name == syms::rev_diff;
 }
 
 void FnDecl::emit_head(CodeGen& cg) const {
     assert(def_ == nullptr);
     // no code is emitted for primops
-    if (is_extern() && abi() == "\"thorin\"" && is_primop(symbol()))
+    if (is_extern() && abi() == syms::abi_thorin && is_primop(symbol()))
         return;
 
     // create thorin function
     def_ = fn_emit_head(cg, loc());
-    if (is_extern() && abi() == "")
+    if (is_extern() && abi().empty())
         lam_->make_external();
 
     // handle main function
-    if (symbol() == "main")
+    if (symbol() == syms::main)
         lam()->make_external();
 }
 
 void FnDecl::emit(CodeGen& cg) const {
-    if (body())
+    if (body()) {
+        Trace::Span span("emit", symbol().view(), loc());
         fn_emit_body(cg, loc());
+    }
 }
 
 void ExternBlock::emit_head(CodeGen& cg) const {
     for (auto&& fn_decl : fn_decls()) {
         fn_decl->emit_head(cg);
         auto lam = fn_decl->lam();
-        if (abi() == "\"C\"")
+        if (abi() == syms::abi_c)
             lam->set_cc(thorin::Lam::CC::C);
-        else if (abi() == "\"device\"")
+        else if (abi() == syms::abi_device)
             lam->set_cc(thorin::Lam::CC::Device);
-        else if (abi() == "\"thorin\"" && lam) // no lam for primops
+        else if (abi() == syms::abi_thorin && lam) // no lam for primops
             lam->set_intrinsic();
     }
 }
@@ -349,27 +760,41 @@ void StructDecl::emit_head(CodeGen& cg) const {
     cg.convert(type());
 }
 
-void OptionDecl::emit(CodeGen& /*cg*/) const {
-#if 0
-    auto enum_type = enum_decl()->type()->as<EnumType>();
-    auto variant_type = cg.convert(enum_type)->op(1)->as<VariantType>();
-    auto id = cg.world.lit_int(index(), cg.loc2dbg(loc()));
+void OptionDecl::emit(CodeGen& cg) const {
+    auto enum_type = enum_decl()->enum_type();
+    auto enum_layout = cg.enum_layout(enum_type);
+    auto thorin_type = cg.convert(enum_type);
+    auto id = cg.world.lit(enum_layout.tag_type, index(), cg.loc2dbg(loc()));
     if (num_args() == 0) {
-        auto bot = cg.world.bot(variant_type);
-        def_ = cg.world.tuple(cg.thorin_enum_type(enum_type), { id, bot });
+        if (auto storage = enum_layout.storage) {
+            Array<const Def*> fields(storage->num_ops());
+            for (size_t i = 0, e = fields.size() - 1; i != e; ++i)
+                fields[i] = cg.world.bot(storage->op(i));
+            fields.back() = id;
+            def_ = cg.world.tuple(thorin_type, fields, cg.loc2dbg(loc()));
+        }
+        else
+            def_ = id;
     } else {
         auto lam = cg.world.lam(cg.convert(type())->as<thorin::Pi>(), cg.loc2dbg(symbol().c_str(), loc()));
+        THORIN_PUSH(cg.cur_bb, lam);
+        THORIN_PUSH(cg.cur_mem, lam->param(0, {"mem"}));
         auto ret = lam->param(lam->num_params() - 1);
-        auto mem = lam->param(0);
+        auto order = cg.payload_order(this);
         Array<const Def*> defs(num_args());
-        for (size_t i = 1, e = lam->num_params(); i + 1 < e; i++)
-            defs[i-1] = lam->param(i);
-        auto option_val = num_args() == 1 ? defs.back() : cg.world.tuple(defs);
-        auto enum_val = cg.world.tuple(cg.thorin_enum_type(enum_type), { id, cg.world.variant(variant_type, option_val) });
-        lam->app(ret, { mem, enum_val }, cg.loc2dbg(loc()));
+        for (size_t i = 0, e = num_args(); i != e; ++i)
+            defs[i] = lam->param(order[i] + 1);
+        auto variant = num_args() == 1 ? defs.back() : cg.world.tuple(defs);
+
+        // the variant may clobber its tail padding - thus, the tag goes in last
+        auto dbg = cg.loc2dbg(loc());
+        auto ptr = cg.slot(thorin_type, dbg);
+        cg.cur_mem = cg.world.op_store(cg.cur_mem, cg.world.op_bitcast(cg.world.type_ptr(variant->type()), ptr, dbg), variant, dbg);
+        cg.cur_mem = cg.world.op_store(cg.cur_mem, cg.world.op_lea_unsafe(ptr, thorin_type->num_ops() - 1, dbg), id, dbg);
+        auto enum_val = cg.handle_mem_res(cg.world.op_load(cg.cur_mem, ptr, dbg));
+        lam->app(ret, {cg.cur_mem, enum_val}, cg.loc2dbg(loc()));
         def_ = lam;
     }
-#endif
 }
 
 void EnumDecl::emit_head(CodeGen& cg) const {
@@ -467,7 +892,7 @@ const Def* RValueExpr::lemit(CodeGen& cg) const {
 
 const Def* RValueExpr::remit(CodeGen& cg) const {
     if (src()->type()->isa<RefType>())
-        return cg.load(lemit(cg), loc());
+        return cg.load(cg.lemit(src()), loc());
     return src()->remit(cg);
 }
 
@@ -477,6 +902,9 @@ const Def* PathExpr::lemit(CodeGen&) const {
 }
 
 const Def* PathExpr::remit(CodeGen& cg) const {
+    if (auto local = value_decl()->isa<LocalDecl>(); local && cg.is_ssa(local))
+        return cg.read(local);
+
     auto def = value_decl()->def();
     // This whole global thing is incorrect.
     // Example:
@@ -493,21 +921,17 @@ const Def* PathExpr::remit(CodeGen& cg) const {
     return value_decl()->is_mut() || global ? cg.load(def, loc()) : def;
 }
 
-static flags_t type2wmode(const Type* type) {
-    return is_bool(type) ? WMode::nuw : (is_signed(type) ? WMode::nsw : WMode::none);
-}
-
 const Def* PrefixExpr::remit(CodeGen& cg) const {
     switch (tag()) {
         case INC:
         case DEC: {
-            auto var = rhs()->lemit(cg);
+            auto var = cg.lemit(rhs());
             auto val = cg.load(var, loc());
             auto one = cg.lit_one(type(), cg.loc2dbg(loc()));
             if (is_int(type()))
-                val = cg.world.op(tag() == INC ? WOp::add : WOp::sub, type2wmode(type()), val, one, cg.loc2dbg(loc()));
+                val = cg.arith(tag() == INC ? WOp::add : WOp::sub, type(), val, one, cg.loc2dbg(loc()));
             else
-                val = cg.world.op(tag() == INC ? ROp::add : ROp::sub, RMode::none, val, one, cg.loc2dbg(loc()));
+                val = cg.world.op(tag() == INC ? ROp::add : ROp::sub, cg.rmode, val, one, cg.loc2dbg(loc()));
             cg.store(var, val, loc());
             return val;
         }
@@ -517,7 +941,7 @@ const Def* PrefixExpr::remit(CodeGen& cg) const {
                 auto mode = type2wmode(type());
                 return cg.world.op_WOp_minus(mode, rhs()->remit(cg), cg.loc2dbg(loc()));
             } else {
-                return cg.world.op_ROp_minus(RMode::none, rhs()->remit(cg), cg.loc2dbg(loc()));
+                return cg.world.op_ROp_minus(cg.rmode, rhs()->remit(cg), cg.loc2dbg(loc()));
             }
         case NOT:
             if (is_bool(type()))
@@ -569,29 +993,28 @@ const Def* PrefixExpr::lemit(CodeGen& cg) const {
     return rhs()->remit(cg);
 }
 
-void Expr::emit_branch(CodeGen& cg, Lam* jump_t, Lam* jump_f) const {
+void Expr::emit_branch(CodeGen& cg, Join& jump_t, Join& jump_f) const {
     auto expr_t = cg.basicblock(cg.loc2dbg("expr_t", loc().back()));
     auto expr_f = cg.basicblock(cg.loc2dbg("expr_f", loc().back()));
     auto cond = remit(cg);
     cg.cur_bb->branch(cond, expr_t, expr_f, cg.cur_mem, cg.loc2dbg(loc().back()));
     cg.enter(expr_t);
-    expr_t->app(jump_t, { cg.cur_mem });
+    cg.jump(jump_t, {});
     cg.enter(expr_f);
-    expr_f->app(jump_f, { cg.cur_mem });
+    cg.jump(jump_f, {});
 }
 
-void InfixExpr::emit_branch(CodeGen& cg, Lam* jump_t, Lam* jump_f) const {
-    auto jump_type = jump_t->type();
+void InfixExpr::emit_branch(CodeGen& cg, Join& jump_t, Join& jump_f) const {
     switch (tag()) {
         case OROR: {
-                auto or_f = cg.world.lam(jump_type, cg.loc2dbg("or_f", loc().back()));
+                Join or_f(nullptr, cg.loc2dbg("or_f", loc().back()));
                 lhs()->emit_branch(cg, jump_t, or_f);
                 cg.enter(or_f);
                 rhs()->emit_branch(cg, jump_t, jump_f);
             }
             break;
         case ANDAND: {
-                auto and_t = cg.world.lam(jump_type, cg.loc2dbg("and_t", loc().back()));
+                Join and_t(nullptr, cg.loc2dbg("and_t", loc().back()));
                 lhs()->emit_branch(cg, and_t, jump_f);
                 cg.enter(and_t);
                 rhs()->emit_branch(cg, jump_t, jump_f);
@@ -606,13 +1029,14 @@ const Def* InfixExpr::remit(CodeGen& cg) const {
     switch (tag()) {
         case OROR:
         case ANDAND: {
-            auto result    = cg.basicblock(cg.world.type_bool(), cg.loc2dbg("infix_result", loc().back()));
-            auto jump_type = cg.world.cn({ cg.world.type_mem() });
-            auto jump_t    = cg.world.lam(jump_type, cg.loc2dbg("jump_t", loc().back()));
-            auto jump_f    = cg.world.lam(jump_type, cg.loc2dbg("jump_f", loc().back()));
+            Join result(cg.world.type_bool(), cg.loc2dbg("infix_result", loc().back()));
+            Join jump_t(nullptr, cg.loc2dbg("jump_t", loc().back()));
+            Join jump_f(nullptr, cg.loc2dbg("jump_f", loc().back()));
             emit_branch(cg, jump_t, jump_f);
-            jump_t->app(result, { jump_t->param(0), cg.world.lit_true() });
-            jump_f->app(result, { jump_f->param(0), cg.world.lit_false() });
+            cg.enter(jump_t);
+            cg.jump(result, cg.world.lit_true(), {});
+            cg.enter(jump_f);
+            cg.jump(result, cg.world.lit_false(), {});
             return cg.enter(result)->param(1);
         }
         default: {
@@ -620,7 +1044,7 @@ const Def* InfixExpr::remit(CodeGen& cg) const {
             auto dbg = cg.loc2dbg(loc());
 
             if (Token::is_assign((TokenTag) op)) {
-                auto lvar = lhs()->lemit(cg);
+                auto lvar = cg.lemit(lhs());
                 auto rdef = rhs()->remit(cg);
 
                 if (op == ASGN) {
@@ -628,15 +1052,15 @@ const Def* InfixExpr::remit(CodeGen& cg) const {
                     return cg.world.tuple();
                 }
 
-                auto ldef = cg.load(lhs()->lemit(cg), loc());
+                auto ldef = cg.load(lvar, loc());
 
                 if (is_float(rhs()->type())) {
                     switch (op) {
-                        case ADD_ASGN: rdef = cg.world.op(ROp::add, RMode::none, ldef, rdef, dbg); break;
-                        case SUB_ASGN: rdef = cg.world.op(ROp::sub, RMode::none, ldef, rdef, dbg); break;
-                        case MUL_ASGN: rdef = cg.world.op(ROp::mul, RMode::none, ldef, rdef, dbg); break;
-                        case DIV_ASGN: rdef = cg.world.op(ROp::div, RMode::none, ldef, rdef, dbg); break;
-                        case REM_ASGN: rdef = cg.world.op(ROp::mod, RMode::none, ldef, rdef, dbg); break;
+                        case ADD_ASGN: rdef = cg.world.op(ROp::add, cg.rmode, ldef, rdef, dbg); break;
+                        case SUB_ASGN: rdef = cg.world.op(ROp::sub, cg.rmode, ldef, rdef, dbg); break;
+                        case MUL_ASGN: rdef = cg.world.op(ROp::mul, cg.rmode, ldef, rdef, dbg); break;
+                        case DIV_ASGN: rdef = cg.world.op(ROp::div, cg.rmode, ldef, rdef, dbg); break;
+                        case REM_ASGN: rdef = cg.world.op(ROp::mod, cg.rmode, ldef, rdef, dbg); break;
                         default: THORIN_UNREACHABLE;
                     }
                 } else if (is_bool(rhs()->type())) {
@@ -647,17 +1071,17 @@ const Def* InfixExpr::remit(CodeGen& cg) const {
                         default: THORIN_UNREACHABLE;
                     }
                 } else {
-                    auto mode = type2wmode(rhs()->type());
-                    bool s = is_signed(rhs()->type());
+                    auto type = rhs()->type();
+                    bool s = is_signed(type);
 
                     switch (op) {
                         case AND_ASGN: rdef = cg.world.op(Bit::_and, ldef, rdef, dbg); break;
                         case  OR_ASGN: rdef = cg.world.op(Bit:: _or, ldef, rdef, dbg); break;
                         case XOR_ASGN: rdef = cg.world.op(Bit::_xor, ldef, rdef, dbg); break;
-                        case ADD_ASGN: rdef = cg.world.op(WOp:: add, mode, ldef, rdef, dbg); break;
-                        case SUB_ASGN: rdef = cg.world.op(WOp:: sub, mode, ldef, rdef, dbg); break;
-                        case MUL_ASGN: rdef = cg.world.op(WOp:: mul, mode, ldef, rdef, dbg); break;
-                        case SHL_ASGN: rdef = cg.world.op(WOp:: shl, mode, ldef, rdef, dbg); break;
+                        case ADD_ASGN: rdef = cg.arith(WOp:: add, type, ldef, rdef, dbg); break;
+                        case SUB_ASGN: rdef = cg.arith(WOp:: sub, type, ldef, rdef, dbg); break;
+                        case MUL_ASGN: rdef = cg.arith(WOp:: mul, type, ldef, rdef, dbg); break;
+                        case SHL_ASGN: rdef = cg.arith(WOp:: shl, type, ldef, rdef, dbg); break;
                         case SHR_ASGN: rdef = cg.world.op(s ? Shr::a : Shr::l, ldef, rdef, dbg); break;
                         case DIV_ASGN: rdef = cg.handle_mem_res(cg.world.op(s ? ZOp::sdiv : ZOp::udiv, cg.cur_mem, ldef, rdef, dbg)); break;
                         case REM_ASGN: rdef = cg.handle_mem_res(cg.world.op(s ? ZOp::smod : ZOp::umod, cg.cur_mem, ldef, rdef, dbg)); break;
@@ -674,17 +1098,17 @@ const Def* InfixExpr::remit(CodeGen& cg) const {
 
             if (is_float(rhs()->type())) {
                 switch (op) {
-                    case  EQ: return cg.world.op(RCmp::  e, RMode::none, ldef, rdef, dbg);
-                    case  NE: return cg.world.op(RCmp::une, RMode::none, ldef, rdef, dbg);
-                    case  LT: return cg.world.op(RCmp::  l, RMode::none, ldef, rdef, dbg);
-                    case  LE: return cg.world.op(RCmp:: le, RMode::none, ldef, rdef, dbg);
-                    case  GT: return cg.world.op(RCmp::  g, RMode::none, ldef, rdef, dbg);
-                    case  GE: return cg.world.op(RCmp:: ge, RMode::none, ldef, rdef, dbg);
-                    case ADD: return cg.world.op(ROp ::add, RMode::none, ldef, rdef, dbg);
-                    case SUB: return cg.world.op(ROp ::sub, RMode::none, ldef, rdef, dbg);
-                    case MUL: return cg.world.op(ROp ::mul, RMode::none, ldef, rdef, dbg);
-                    case DIV: return cg.world.op(ROp ::div, RMode::none, ldef, rdef, dbg);
-                    case REM: return cg.world.op(ROp ::mod, RMode::none, ldef, rdef, dbg);
+                    case  EQ: return cg.world.op(RCmp::  e, cg.rmode, ldef, rdef, dbg);
+                    case  NE: return cg.world.op(RCmp::une, cg.rmode, ldef, rdef, dbg);
+                    case  LT: return cg.world.op(RCmp::  l, cg.rmode, ldef, rdef, dbg);
+                    case  LE: return cg.world.op(RCmp:: le, cg.rmode, ldef, rdef, dbg);
+                    case  GT: return cg.world.op(RCmp::  g, cg.rmode, ldef, rdef, dbg);
+                    case  GE: return cg.world.op(RCmp:: ge, cg.rmode, ldef, rdef, dbg);
+                    case ADD: return cg.world.op(ROp ::add, cg.rmode, ldef, rdef, dbg);
+                    case SUB: return cg.world.op(ROp ::sub, cg.rmode, ldef, rdef, dbg);
+                    case MUL: return cg.world.op(ROp ::mul, cg.rmode, ldef, rdef, dbg);
+                    case DIV: return cg.world.op(ROp ::div, cg.rmode, ldef, rdef, dbg);
+                    case REM: return cg.world.op(ROp ::mod, cg.rmode, ldef, rdef, dbg);
                     default: THORIN_UNREACHABLE;
                 }
             } else if (is_bool(rhs()->type())) {
@@ -697,8 +1121,8 @@ const Def* InfixExpr::remit(CodeGen& cg) const {
                     default: THORIN_UNREACHABLE;
                 }
             } else {
-                auto mode = type2wmode(lhs()->type());
-                bool s = is_signed(lhs()->type());
+                auto type = lhs()->type();
+                bool s = is_signed(type);
 
                 if (thorin::isa<thorin::Tag::Ptr>(ldef->type())) ldef = cg.world.op_bitcast(cg.world.type_int(64), ldef);
                 if (thorin::isa<thorin::Tag::Ptr>(rdef->type())) rdef = cg.world.op_bitcast(cg.world.type_int(64), rdef);
@@ -714,10 +1138,10 @@ const Def* InfixExpr::remit(CodeGen& cg) const {
                     case  OR: return cg.world.op(Bit:: _or, ldef, rdef, dbg);
                     case XOR: return cg.world.op(Bit::_xor, ldef, rdef, dbg);
                     case SHR: return cg.world.op(s ? Shr::a : Shr::l, ldef, rdef, dbg);
-                    case ADD: return cg.world.op(WOp :: add, mode, ldef, rdef, dbg);
-                    case SUB: return cg.world.op(WOp :: sub, mode, ldef, rdef, dbg);
-                    case MUL: return cg.world.op(WOp :: mul, mode, ldef, rdef, dbg);
-                    case SHL: return cg.world.op(WOp :: shl, mode, ldef, rdef, dbg);
+                    case ADD: return cg.arith(WOp :: add, type, ldef, rdef, dbg);
+                    case SUB: return cg.arith(WOp :: sub, type, ldef, rdef, dbg);
+                    case MUL: return cg.arith(WOp :: mul, type, ldef, rdef, dbg);
+                    case SHL: return cg.arith(WOp :: shl, type, ldef, rdef, dbg);
                     case DIV: return cg.handle_mem_res(cg.world.op(s ? ZOp::sdiv : ZOp::udiv, cg.cur_mem, ldef, rdef, dbg));
                     case REM: return cg.handle_mem_res(cg.world.op(s ? ZOp::smod : ZOp::umod, cg.cur_mem, ldef, rdef, dbg));
                     default: THORIN_UNREACHABLE;
@@ -728,15 +1152,15 @@ const Def* InfixExpr::remit(CodeGen& cg) const {
 }
 
 const Def* PostfixExpr::remit(CodeGen& cg) const {
-    auto var = lhs()->lemit(cg);
+    auto var = cg.lemit(lhs());
     auto res = cg.load(var, loc());
     auto one = cg.lit_one(type(), cg.loc2dbg(loc()));
     const Def* val = nullptr;
 
     if (is_int(type()))
-        val = cg.world.op(tag() == INC ? WOp::add : WOp::sub, type2wmode(type()), res, one, cg.loc2dbg(loc()));
+        val = cg.arith(tag() == INC ? WOp::add : WOp::sub, type(), res, one, cg.loc2dbg(loc()));
     else
-        val = cg.world.op(tag() == INC ? ROp::add : ROp::sub, RMode::none, res, one, cg.loc2dbg(loc()));
+        val = cg.world.op(tag() == INC ? ROp::add : ROp::sub, cg.rmode, res, one, cg.loc2dbg(loc()));
     cg.store(var, val, loc());
     return res;
 }
@@ -791,19 +1215,19 @@ const Def* MapExpr::remit(CodeGen& cg) const {
             auto callee = type_expr->lhs()->skip_rvalue();
             if (auto path = callee->isa<PathExpr>()) {
                 if (auto fn_decl = path->value_decl()->isa<FnDecl>()) {
-                    if (fn_decl->is_extern() && fn_decl->abi() == "\"thorin\"") {
-                        auto name = fn_decl->fn_symbol().remove_quotation();
-                        if (name == "bitcast") {
+                    if (fn_decl->is_extern() && fn_decl->abi() == syms::abi_thorin) {
+                        auto name = fn_decl->fn_symbol().unquoted();
+                        if (name == syms::bitcast.view()) {
                             return cg.world.op_bitcast(cg.convert(type_expr->type_arg(0)), arg(0)->remit(cg), cg.loc2dbg(loc()));
-                        } else if (name == "select") {
+                        } else if (name == syms::select.view()) {
                             return cg.world.extract(cg.world.tuple({arg(2)->remit(cg), arg(1)->remit(cg)}), arg(0)->remit(cg), cg.loc2dbg(loc()));
-                        } else if (name == "insert") {
+                        } else if (name == syms::insert.view()) {
                             return cg.world.insert_unsafe(arg(0)->remit(cg), arg(1)->remit(cg), arg(2)->remit(cg), cg.loc2dbg(loc()));
-                        } else if (name == "sizeof") {
+                        } else if (name == syms::size_of.view()) {
                             return cg.world.op_bitcast(cg.world.type_int(32), cg.world.op_sizeof(cg.convert(type_expr->type_arg(0)), cg.loc2dbg(loc())));
-                        } else if (name == "undef") {
+                        } else if (name == syms::undef.view()) {
                             return cg.world.bot(cg.convert(type_expr->type_arg(0)), cg.loc2dbg(loc()));
-                        } else if (name == "reserve_shared") {
+                        } else if (name == syms::reserve_shared.view()) {
                             auto ptr = cg.convert(type());
                             auto cn = cg.world.cn({
                                 cg.world.type_mem(), cg.world.type_int(32),
@@ -811,7 +1235,7 @@ const Def* MapExpr::remit(CodeGen& cg) const {
                             auto cont = cg.world.lam(cn, cg.loc2dbg("reserve_shared", loc()));
                             cont->set_intrinsic();
                             dst = cont;
-                        } else if (name == "atomic") {
+                        } else if (name == syms::atomic.view()) {
                             auto poly_type = cg.convert(type());
                             auto ptr = cg.convert(arg(1)->type());
                             auto cn = cg.world.cn({
@@ -820,7 +1244,7 @@ const Def* MapExpr::remit(CodeGen& cg) const {
                             auto cont = cg.world.lam(cn, cg.loc2dbg("atomic", loc()));
                             cont->set_intrinsic();
                             dst = cont;
-                        } else if (name == "cmpxchg") {
+                        } else if (name == syms::cmpxchg.view()) {
                             auto ptr = thorin::as<thorin::Tag::Ptr>(cg.convert(arg(0)->type()));
                             auto [pointee, addr_space] = ptr->args<2>();
                             auto poly_type = pointee;
@@ -831,7 +1255,7 @@ const Def* MapExpr::remit(CodeGen& cg) const {
                             auto cont = cg.world.lam(cn, cg.loc2dbg("cmpxchg", loc()));
                             cont->set_intrinsic();
                             dst = cont;
-                        } else if (name == "pe_info") {
+                        } else if (name == syms::pe_info.view()) {
                             auto poly_type = cg.convert(arg(1)->type());
                             auto string_type = cg.world.type_ptr(cg.world.arr_unsafe(cg.world.type_int(8)));
                             auto cn = cg.world.cn({
@@ -840,7 +1264,7 @@ const Def* MapExpr::remit(CodeGen& cg) const {
                             auto cont = cg.world.lam(cn, cg.loc2dbg("pe_info", loc()));
                             cont->set_intrinsic();
                             dst = cont;
-                        } else if (name == "pe_known") {
+                        } else if (name == syms::pe_known.view()) {
                             auto poly_type = cg.convert(arg(0)->type());
                             auto cn = cg.world.cn({
                                 cg.world.type_mem(), poly_type,
@@ -860,6 +1284,10 @@ const Def* MapExpr::remit(CodeGen& cg) const {
         defs.push_back(nullptr);    // reserve for mem but set later - some other args may update mem
         for (auto&& arg : args())
             defs.push_back(arg.get()->remit(cg));
+        if (auto carried = cg.continuation(lhs())) {
+            for (auto local : *carried)
+                defs.push_back(cg.read(local));
+        }
         defs.front() = cg.cur_mem; // now get the current memory value
 
         auto ret_type = num_args() == cn->num_params() ? nullptr : cg.convert(cn->return_type());
@@ -886,112 +1314,157 @@ const Def* FieldExpr::remit(CodeGen& cg) const {
 }
 
 const Def* BlockExpr::remit(CodeGen& cg) const {
+    THORIN_PUSH(cg.rmode, arith_attrs().apply_rmode(cg.rmode));
+    THORIN_PUSH(cg.nuw,   arith_attrs().apply_nuw(cg.nuw));
+
     for (auto&& stmt : stmts()) {
         if (auto item_stmnt = stmt->isa<ItemStmt>())
             item_stmnt->item()->emit_head(cg);
     }
 
+    auto num_vars = cg.vars.size();
     for (auto&& stmt : stmts()) stmt->emit(cg);
 
-    return expr()->remit(cg);
+    auto result = expr()->remit(cg);
+    cg.vars.resize(num_vars); // locals of this block go out of scope
+    return result;
 }
 
 const Def* IfExpr::remit(CodeGen& cg) const {
     auto thorin_type = cg.convert(type());
 
-    auto jump_type = cg.world.cn({ cg.world.type_mem() });
-    auto if_then = cg.world.lam(jump_type, cg.loc2dbg("if_then", then_expr()->loc().front()));
-    auto if_else = cg.world.lam(jump_type, cg.loc2dbg("if_else", else_expr()->loc().front()));
-    auto if_join = thorin_type ? cg.basicblock(thorin_type, cg.loc2dbg("if_join", loc().back())) : nullptr; // TODO rewrite with bottom type
+    Join if_then(nullptr, cg.loc2dbg("if_then", then_expr()->loc().front()));
+    Join if_else(nullptr, cg.loc2dbg("if_else", else_expr()->loc().front()));
+    Join if_join(thorin_type, cg.loc2dbg("if_join", loc().back())); // TODO rewrite with bottom type
 
     cond()->emit_branch(cg, if_then, if_else);
 
     cg.enter(if_then);
     if (auto tdef = then_expr()->remit(cg))
-        cg.cur_bb->app(if_join, {cg.cur_mem, tdef}, cg.loc2dbg(loc().back()));
+        cg.jump(if_join, tdef, cg.loc2dbg(loc().back()));
 
     cg.enter(if_else);
     if (auto fdef = else_expr()->remit(cg))
-        cg.cur_bb->app(if_join, {cg.cur_mem, fdef}, cg.loc2dbg(loc().back()));
+        cg.jump(if_join, fdef, cg.loc2dbg(loc().back()));
 
     if (thorin_type)
         return cg.enter(if_join)->param(1);
     return nullptr; // TODO use bottom type
 }
 
-const Def* MatchExpr::remit(CodeGen& /*cg*/) const {
-#if 0
-    auto thorin_type = cg.convert(type());
+/// A dense jump table needs at least this many cases which must cover at least half of the table's entries.
+static const size_t min_jump_table_cases = 3;
 
-    auto join = thorin_type ? cg.basicblock(thorin_type, cg.loc2dbg("match_join", loc().back())) : nullptr; // TODO rewrite with bottom type
+/// Value of the refutable pattern @p ptrn of an integer or simple enum @p MatchExpr - sign-extended to 64 bits.
+static u64 case_value(const Ptrn* ptrn) {
+    if (auto literal = ptrn->isa<LiteralPtrn>()) {
+        auto value = literal->literal()->get<u64>();
+        return literal->has_minus() ? 0 - value : value;
+    }
+    if (auto chr = ptrn->isa<CharPtrn>())
+        return u8(chr->chr()->value());
+    return ptrn->as<EnumPtrn>()->path()->decl()->as<OptionDecl>()->index();
+}
+
+const Def* MatchExpr::remit(CodeGen& cg) const {
+    auto thorin_type = cg.convert(type());
+    Join join(thorin_type, cg.loc2dbg("match_join", loc().back())); // TODO rewrite with bottom type
 
     auto matcher = expr()->remit(cg);
     auto enum_type = expr()->type()->isa<EnumType>();
     bool is_integer = is_int(expr()->type());
     bool is_simple = enum_type && enum_type->enum_decl()->is_simple();
 
-    if (is_integer || is_simple) {
-        // integers: match lam
-        Lam* otherwise = nullptr;
-        size_t num_targets = num_arms();
-        Array<const Def*> defs(num_targets);
-        Array<Lam*> targets(num_targets);
+    // each arm starts from the same SSA values
+    auto vars = cg.vars;
+    auto emit_arm = [&](const Arm* arm) {
+        cg.vars = vars;
+        arm->ptrn()->emit(cg, matcher);
+        if (auto def = arm->expr()->remit(cg))
+            cg.jump(join, def, cg.loc2dbg(arm->loc().back()));
+    };
 
-        for (size_t i = 0, e = num_targets; i != e; ++i) {
-            // last pattern will always be taken
-            if (!arm(i)->ptrn()->is_refutable() || i == e - 1) {
-                num_targets = i;
-                arm(i)->ptrn()->emit(cg, matcher);
-                otherwise = cg.basicblock(cg.loc2dbg("otherwise", arm(i)->loc().front()));
+    if (is_integer || is_simple) {
+        // the first irrefutable arm - or the last one - is taken otherwise; the remaining arms are unreachable
+        size_t num_cases = num_arms() - 1;
+        for (size_t i = 0, e = num_arms(); i != e; ++i) {
+            if (!arm(i)->ptrn()->is_refutable()) {
+                num_cases = i;
                 break;
-            } else {
-                if (is_integer) {
-                    defs[i] = arm(i)->ptrn()->emit(cg);
-                } else {
-                    auto enum_ptrn = arm(i)->ptrn()->as<EnumPtrn>();
-                    auto option_decl = enum_ptrn->path()->decl()->as<OptionDecl>();
-                    defs[i] = cg.world.lit_int(64, option_decl->index(), cg.loc2dbg(arm(i)->ptrn()->loc()));
-                }
-                targets[i] = cg.basicblock(cg.loc2dbg("case", arm(i)->loc().front()));
             }
         }
 
-        targets.shrink(num_targets);
-        defs.shrink(num_targets);
+        // keys are the case values in an order-preserving unsigned representation
+        bool is_signed_matcher = is_integer && is_signed(expr()->type());
+        std::vector<u64> keys(num_cases);
+        std::vector<const Def*> defs(num_cases);
+        std::vector<Lam*> targets(num_cases);
+        for (size_t i = 0; i != num_cases; ++i) {
+            auto ptrn = arm(i)->ptrn();
+            keys[i] = case_value(ptrn) ^ (is_signed_matcher ? u64(1) << 63 : 0);
+            defs[i] = is_integer ? ptrn->emit(cg) : cg.world.lit(cg.enum_layout(enum_type).tag_type, keys[i], cg.loc2dbg(ptrn->loc()));
+            targets[i] = cg.basicblock(cg.loc2dbg("case", arm(i)->loc().front()));
+        }
+        auto otherwise = cg.basicblock(cg.loc2dbg("otherwise", arm(num_cases)->loc().front()));
+        auto matcher_int = is_integer ? matcher : cg.enum_tag(enum_type, matcher, matcher->debug());
+        auto dbg = cg.loc2dbg("match", loc().front());
+
+        size_t lo = 0, hi = 0;
+        for (size_t i = 1; i < num_cases; ++i) {
+            if (keys[i] < keys[lo]) lo = i;
+            if (keys[i] > keys[hi]) hi = i;
+        }
 
-        auto matcher_int = is_integer ? matcher : cg.world.extract(matcher, 0_u32, matcher->debug());
-        cg.cur_bb->match(matcher_int, otherwise, defs, targets, cg.loc2dbg("match", loc().front()));
+        if (num_cases >= min_jump_table_cases && keys[hi] - keys[lo] < 2 * num_cases) {
+            // dense cases: one range check and an indirect jump through a table indexed by the matcher minus the smallest case;
+            // this Thorin has no Lam::match, so - just like Lam::branch picks one of two - the table is a tuple of case blocks
+            auto table_bb = cg.basicblock(cg.loc2dbg("jump_table", loc().front()));
+            auto ge = cg.world.op(World::Cmp::ge, matcher_int, defs[lo], dbg);
+            auto le = cg.world.op(World::Cmp::le, matcher_int, defs[hi], dbg);
+            cg.cur_bb->branch(cg.world.extract(Bit::_and, ge, le, dbg), table_bb, otherwise, cg.cur_mem, dbg);
+
+            cg.enter(table_bb);
+            std::vector<const Def*> table(keys[hi] - keys[lo] + 1, otherwise);
+            for (size_t i = num_cases; i-- != 0;)
+                table[keys[i] - keys[lo]] = targets[i]; // the first of several arms with the same value wins
+            auto index = cg.world.op(WOp::sub, WMode::none, matcher_int, defs[lo], dbg);
+            cg.cur_bb->app(cg.world.extract_unsafe(cg.world.tuple(table), index, dbg), {cg.cur_mem}, dbg);
+        } else {
+            // sparse cases: a chain of comparisons
+            for (size_t i = 0; i != num_cases; ++i) {
+                auto next = i + 1 == num_cases ? otherwise : cg.basicblock(cg.loc2dbg("case_f", arm(i)->loc().front()));
+                auto cond = cg.world.op(World::Cmp::eq, matcher_int, defs[i], dbg);
+                cg.cur_bb->branch(cond, targets[i], next, cg.cur_mem, dbg);
+                cg.enter(next);
+            }
+            if (num_cases == 0)
+                cg.cur_bb->app(otherwise, {cg.cur_mem}, dbg);
+        }
 
-        for (size_t i = 0; i != num_targets; ++i) {
+        for (size_t i = 0; i != num_cases; ++i) {
             cg.enter(targets[i]);
-            if (auto def = arm(i)->expr()->remit(cg))
-                cg.cur_bb->app(join, {cg.cur_mem, def}, cg.loc2dbg(loc().back()));
+            emit_arm(arm(i));
         }
 
-        bool no_otherwise = num_arms() == num_targets;
-        if (!no_otherwise) {
-            cg.enter(otherwise);
-            if (auto def = arm(num_targets)->expr()->remit(cg))
-                cg.cur_bb->app(join, {cg.cur_mem, def}, cg.loc2dbg(loc().back()));
-        }
+        cg.enter(otherwise);
+        emit_arm(arm(num_cases));
     } else {
         // general case: if/else
         for (size_t i = 0, e = num_arms(); i != e; ++i) {
-            auto case_t = cg.basicblock(cg.loc2dbg("case_t", arm(i)->loc().front()));
-            auto case_f = cg.basicblock(cg.loc2dbg("case_f", arm(i)->loc().front()));
-
-            arm(i)->ptrn()->emit(cg, matcher);
-
             // last pattern will always be taken
-            auto cond = i == e - 1
-                ? cg.world.lit_true()
-                : arm(i)->ptrn()->emit_cond(cg, matcher);
+            if (i == e - 1) {
+                emit_arm(arm(i));
+                break;
+            }
 
+            auto case_t = cg.basicblock(cg.loc2dbg("case_t", arm(i)->loc().front()));
+            auto case_f = cg.basicblock(cg.loc2dbg("case_f", arm(i)->loc().front()));
+            cg.vars = vars;
+            auto cond = arm(i)->ptrn()->emit_cond(cg, matcher);
             cg.cur_bb->branch(cond, case_t, case_f, cg.cur_mem, cg.loc2dbg(arm(i)->ptrn()->loc().back()));
 
             cg.enter(case_t);
-            if (auto def = arm(i)->expr()->remit(cg))
-                cg.cur_bb->app(join, {cg.cur_mem, def}, cg.loc2dbg(arm(i)->loc().back()));
+            emit_arm(arm(i));
 
             cg.enter(case_f);
         }
@@ -999,36 +1472,43 @@ const Def* MatchExpr::remit(CodeGen& /*cg*/) const {
 
     if (thorin_type)
         return cg.enter(join)->param(1);
-#endif
     return nullptr; // TODO use bottom type
 }
 
 const Def* WhileExpr::remit(CodeGen& cg) const {
-    auto head_bb = cg.world.lam(cg.world.cn({cg.world.type_mem()}), Lam::CC::C, Lam::Intrinsic::None, cg.loc2dbg("while_head", loc().front()));
-    head_bb->param(0, {"mem"});
+    // the head is entered before the back edges are known: each local the loop writes needs a parameter in advance
+    auto carried = cg.carried(written_locals());
+    std::vector<const thorin::Def*> types;
+    for (auto local : carried)
+        types.push_back(cg.convert(local->type()));
 
-    auto jump_type = cg.world.cn({ cg.world.type_mem() });
-    auto body_bb = cg.world.lam(jump_type, cg.loc2dbg("while_body", body()->loc().front()));
-    auto exit_bb = cg.world.lam(jump_type, cg.loc2dbg("while_exit", body()->loc().back()));
-    auto cont_bb = cg.create_lam(continue_decl());
-    auto brk__bb = cg.create_lam(break_decl());
+    auto head_bb = cg.basicblock(types, cg.loc2dbg("while_head", loc().front()));
+    Join body_bb(nullptr, cg.loc2dbg("while_body", body()->loc().front()));
+    Join exit_bb(nullptr, cg.loc2dbg("while_exit", body()->loc().back()));
+    auto cont_bb = cg.create_lam(continue_decl(), carried);
+    auto brk__bb = cg.create_lam(break_decl(), carried);
+    cg.loops.emplace_back(this, carried);
 
-    cg.cur_bb->app(head_bb, {cg.cur_mem}, cg.loc2dbg(cond()->loc().back()));
+    cg.jump(head_bb, carried, cg.loc2dbg(cond()->loc().back()));
 
-    cg.enter(head_bb);
+    cg.enter(head_bb, carried);
+    auto num_vars = cg.vars.size();
     cond()->emit_branch(cg, body_bb, exit_bb);
 
     cg.enter(body_bb);
     body()->remit(cg);
-    cg.cur_bb->app(cont_bb, {cg.cur_mem}, cg.loc2dbg(body()->loc().back()));
+    cg.jump(cont_bb, carried, cg.loc2dbg(body()->loc().back()));
 
-    cg.enter(cont_bb);
-    cg.cur_bb->app(head_bb, {cg.cur_mem}, cg.loc2dbg(body()->loc().back()));
+    cg.vars.resize(num_vars);
+    cg.enter(cont_bb, carried);
+    cg.jump(head_bb, carried, cg.loc2dbg(body()->loc().back()));
 
     cg.enter(exit_bb);
-    cg.cur_bb->app(brk__bb, {cg.cur_mem}, cg.loc2dbg(body()->loc().back()));
+    cg.jump(brk__bb, carried, cg.loc2dbg(body()->loc().back()));
 
-    cg.enter(brk__bb);
+    cg.vars.resize(num_vars);
+    cg.enter(brk__bb, carried);
+    cg.loops.pop_back();
     return cg.world.tuple();
 }
 
@@ -1062,6 +1542,7 @@ const Def* ForExpr::remit(CodeGen& cg) const {
 
 const Def* FnExpr::remit(CodeGen& cg) const {
     auto lam = fn_emit_head(cg, loc());
+    Trace::Span span("emit", syms::lambda.view(), loc());
     fn_emit_body(cg, loc());
     return lam;
 }
@@ -1082,23 +1563,24 @@ const thorin::Def* IdPtrn::emit_cond(CodeGen& cg, const thorin::Def*) const { re
 
 void EnumPtrn::emit(CodeGen& cg, const thorin::Def* init) const {
     if (num_args() == 0) return;
-    auto variant_type = path()->decl()->as<OptionDecl>()->variant_type(cg);
-    auto variant = cg.world.op_bitcast(variant_type, cg.world.extract(init, 1), cg.loc2dbg(loc()));
-    for (size_t i = 0, e = num_args(); i != e; ++i) {
-        arg(i)->emit(cg, num_args() == 1 ? variant : cg.world.extract(variant, i, cg.loc2dbg(loc())));
-    }
+    auto option = path()->decl()->as<OptionDecl>();
+    auto variant = cg.enum_variant(option, init, cg.loc2dbg(loc()));
+    auto order = cg.payload_order(option);
+    for (size_t i = 0, e = num_args(); i != e; ++i)
+        arg(order[i])->emit(cg, num_args() == 1 ? variant : cg.world.extract(variant, i, cg.loc2dbg(loc())));
 }
 
 const thorin::Def* EnumPtrn::emit_cond(CodeGen& cg, const thorin::Def* init) const {
-    auto index = path()->decl()->as<OptionDecl>()->index();
-    auto init_0 = cg.world.extract(init, 0_u32, cg.loc2dbg(loc()));
-    auto cond = cg.world.op(World::Cmp::eq, init_0, cg.world.lit_int(u32(index), cg.loc2dbg(loc())));
+    auto option = path()->decl()->as<OptionDecl>();
+    auto enum_type = option->enum_decl()->enum_type();
+    auto tag = cg.enum_tag(enum_type, init, cg.loc2dbg(loc()));
+    auto cond = cg.world.op(World::Cmp::eq, tag, cg.world.lit(cg.enum_layout(enum_type).tag_type, option->index(), cg.loc2dbg(loc())));
     if (num_args() > 0) {
-        auto variant_type = path()->decl()->as<OptionDecl>()->variant_type(cg);
-        auto variant = cg.world.op_bitcast(variant_type, cg.world.extract(init, 1, cg.loc2dbg(loc())), cg.loc2dbg(loc()));
+        auto variant = cg.enum_variant(option, init, cg.loc2dbg(loc()));
+        auto order = cg.payload_order(option);
         for (size_t i = 0, e = num_args(); i != e; ++i) {
-            if (!arg(i)->is_refutable()) continue;
-            auto arg_cond = arg(i)->emit_cond(cg, num_args() == 1 ? variant : cg.world.extract(variant, i, cg.loc2dbg(loc())));
+            if (!arg(order[i])->is_refutable()) continue;
+            auto arg_cond = arg(order[i])->emit_cond(cg, num_args() == 1 ? variant : cg.world.extract(variant, i, cg.loc2dbg(loc())));
             cond = cg.world.extract(Bit::_and, cond, arg_cond, cg.loc2dbg(loc()));
         }
     }
@@ -1192,8 +1674,8 @@ void AsmStmt::emit(CodeGen& /*cg*/) const {
 
 //------------------------------------------------------------------------------
 
-void emit(World& world, const Module* mod) {
-    CodeGen cg(world);
+void emit(World& world, const Module* mod, const EmitOptions& options) {
+    CodeGen cg(world, options);
     mod->emit(cg);
 }
 
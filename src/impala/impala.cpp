@@ -6,23 +6,36 @@
 
 namespace impala {
 
-int global_num_warnings = 0;
-int global_num_errors = 0;
+std::atomic<int> global_num_warnings = 0;
+std::atomic<int> global_num_errors = 0;
+std::atomic<size_t> global_num_tokens = 0;
 bool fancy_output = false;
+static thread_local std::ostream* diagnostics_stream = nullptr;
 
 bool& fancy() { return fancy_output; }
-int& num_warnings() { return global_num_warnings; }
-int& num_errors() { return global_num_errors; }
+std::atomic<int>& num_warnings() { return global_num_warnings; }
+std::atomic<int>& num_errors() { return global_num_errors; }
+std::atomic<size_t>& num_tokens() { return global_num_tokens; }
+
+std::ostream& diagnostics() { return diagnostics_stream ? *diagnostics_stream : std::cerr; }
+
+DiagnosticsScope::DiagnosticsScope(std::ostream& os)
+    : prev_(diagnostics_stream)
+{
+    diagnostics_stream = &os;
+}
+
+DiagnosticsScope::~DiagnosticsScope() { diagnostics_stream = prev_; }
 
 void init() {
     PrecTable::init();
     Token::init();
 }
 
-void check(std::unique_ptr<TypeTable>& typetable, const Module* mod) {
+void check(std::unique_ptr<TypeTable>& typetable, const Module* mod, size_t num_threads) {
     name_analysis(mod);
-    type_inference(typetable, mod);
-    type_analysis(mod);
+    type_inference(typetable, mod, num_threads);
+    type_analysis(mod, num_threads);
     //borrow_check(mod);
 }
 
@@ -1,6 +1,7 @@
 #ifndef IMPALA_IMPALA_H
 #define IMPALA_IMPALA_H
 
+#include <atomic>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -9,6 +10,7 @@
 #include "thorin/world.h"
 #include "thorin/util/stream.h"
 
+#include "impala/arena.h"
 #include "impala/token.h"
 #include "impala/sema/type.h"
 
@@ -17,16 +19,28 @@ namespace impala {
 class ASTNode;
 class Item;
 class Module;
-typedef std::vector<std::unique_ptr<const Item>> Items;
+class Source;
+typedef ArenaVector<std::unique_ptr<const Item>> Items;
 
 void init();
+void parse(Items&, const Source&);
 void parse(Items&, std::istream&, const char*);
+void parse(Items&, ArrayRef<const Source*>, size_t num_threads);
+void parse(Items&, ArrayRef<std::string> filenames, size_t num_threads);
 void name_analysis(const Module*);
-void type_inference(std::unique_ptr<TypeTable>& typetable, const Module*);
-void type_analysis(const Module*);
+void type_inference(std::unique_ptr<TypeTable>& typetable, const Module*, size_t num_threads = 1);
+void type_analysis(const Module*, size_t num_threads = 1);
 //void borrow_check(const ModContents*);
-void check(std::unique_ptr<TypeTable>& typetable, const Module*);
-void emit(thorin::World&, const Module*);
+void check(std::unique_ptr<TypeTable>& typetable, const Module*, size_t num_threads = 1);
+/// Options of @p emit.
+struct EmitOptions {
+    bool ssa = false; ///< Keep mutable locals whose address is never taken in SSA form instead of stack slots.
+    thorin::nat_t rmode = thorin::RMode::none; ///< Of floating-point operations unless changed by @p ArithAttrs.
+    bool nuw = false;            ///< Assume that unsigned integer arithmetic does not wrap unless changed by @p ArithAttrs.
+    bool check_overflow = false; ///< Abort on signed or - assumed not to wrap - unsigned overflows instead of exploiting them.
+};
+
+void emit(thorin::World&, const Module*, const EmitOptions& = {});
 
 enum class Prec {
     Bottom,
@@ -51,21 +65,48 @@ private:
     friend void impala::init();
 };
 
-int& num_warnings();
-int& num_errors();
+std::atomic<int>& num_warnings();
+std::atomic<int>& num_errors();
+/// Tokens consumed by all @p parse calls so far.
+std::atomic<size_t>& num_tokens();
 bool& fancy();
 
+/// Counters of the last @p type_inference run.
+struct InferStats {
+    size_t units    = 0; ///< Top-level @p Item%s; each one is inferred as a whole.
+    size_t passes   = 0; ///< Full passes over the @p Module.
+    size_t rounds   = 0; ///< Worklist rounds in between which only infer the units affected by the last changes.
+    size_t revisits = 0; ///< Units inferred by these rounds.
+    size_t isolated = 0; ///< @p FnDecl bodies inferred in isolation - possibly in parallel.
+    size_t escaped  = 0; ///< @p FnDecl bodies which needed unresolved types of other items and fell back to the worklist.
+};
+
+InferStats& infer_stats();
+
+/// Stream the calling thread reports warnings and errors to; @c std::cerr unless redirected by a @p DiagnosticsScope.
+std::ostream& diagnostics();
+
+/// Redirects the @p diagnostics of the calling thread to @p os until the @p DiagnosticsScope dies.
+class DiagnosticsScope {
+public:
+    DiagnosticsScope(std::ostream& os);
+    ~DiagnosticsScope();
+
+private:
+    std::ostream* prev_;
+};
+
 template<class... Args>
 void warning(const Loc& loc, const char* fmt, Args... args) {
     ++num_warnings();
-    Stream s(std::cerr);
+    Stream s(diagnostics());
     s.fmt("{}: warning: ", loc).fmt(fmt, std::forward<Args>(args)...).endl();
 }
 
 template<class... Args>
 void error(const Loc& loc, const char* fmt, Args... args) {
     ++num_errors();
-    Stream s(std::cerr);
+    Stream s(diagnostics());
     s.fmt("{}: error: ", loc).fmt(fmt, std::forward<Args>(args)...).endl();
 }
 
@@ -5,6 +5,7 @@
 #include <stdexcept>
 
 #include "impala/impala.h"
+#include "impala/scan.h"
 
 using namespace thorin;
 
@@ -20,44 +21,58 @@ static inline bool hex(int c) { return std::isxdigit(c) != 0; }
 static inline bool eE(int c) { return c == 'e' || c == 'E'; }
 static inline bool sgn(int c){ return c == '+' || c == '-'; }
 
+Lexer::Lexer(const Source& source)
+    : filename_(source.filename())
+    , begin_(source.begin())
+    , ptr_(source.begin())
+    , end_(source.end())
+    , front_(ptr_)
+    , back_(ptr_)
+    , base_(source.base())
+{}
+
 Lexer::Lexer(std::istream& stream, const char* filename)
-    : stream_(stream)
+    : buffered_(std::make_unique<Source>(stream, filename))
     , filename_(filename)
-{
-    if (!stream_)
-        throw std::runtime_error("stream is bad");
-
-    stream_.exceptions(std::istream::badbit);
-}
+    , begin_(buffered_->begin())
+    , ptr_(begin_)
+    , end_(buffered_->end())
+    , front_(ptr_)
+    , back_(ptr_)
+    , base_(buffered_->base())
+{}
 
 int Lexer::next() {
-    int c = stream_.get();
-
-    back_line_ = peek_line_;
-    back_col_  = peek_col_;
+    back_ = ptr_;
+    if (ptr_ == end_)
+        return std::istream::traits_type::eof();
+    return (unsigned char) *ptr_++;
+}
 
-    if (c == '\n') {
-        ++peek_line_;
-        peek_col_ = 1;
-    } else if (c != std::istream::traits_type::eof())
-        ++peek_col_;
+/// Consumes all characters up to @p to.
+void Lexer::skip(const char* to) {
+    assert(ptr_ < to && to <= end_);
+    back_ = to - 1;
+    ptr_ = to;
+}
 
-    return c;
+void Lexer::lex_dec() {
+    auto e = scan::skip_dec(ptr_, end_);
+    if (e != ptr_)
+        skip(e);
 }
 
 Token Lexer::lex() {
     while (true) {
-        std::string str; // the token string is concatenated here
-        front_line_ = peek_line_;
-        front_col_ = peek_col_;
+        auto begin = front_ = ptr_; // the spelling of the current token starts here
 
         // end of file
         if (accept(std::istream::traits_type::eof()))
             return {loc(), Token::Eof};
 
         // skip whitespace
-        if (accept(space)) {
-            while (accept(space)) {}
+        if (space(peek())) {
+            skip(scan::skip_space(ptr_, end_));
             continue;
         }
 
@@ -108,24 +123,26 @@ Token Lexer::lex() {
         IMPALA_LEX_REL_SHIFT('>', GT, GE, SHR, SHR_ASGN)
 
         // /, /=, comments
-#define IMPALA_WITHIN_COMMENT(delim) \
-        while (true) { \
-            if (accept(std::istream::traits_type::eof())) { \
+#define IMPALA_SKIP_COMMENT(find, delim_len) \
+        { \
+            auto delim = find(ptr_, end_); \
+            if (delim == end_) { \
+                if (ptr_ != end_) skip(end_); \
+                next(); /* eof */ \
                 error(loc().front(), "unterminated comment"); \
                 return {loc(), Token::Eof}; \
             } \
-            if (delim) break; \
-            next(); /* eat up char in comment */\
+            skip(delim + delim_len); \
         }
         if (accept('/')) {
             if (accept('='))
                 return {loc(), Token::DIV_ASGN};
             if (accept('*')) { // arbitrary comment
-                IMPALA_WITHIN_COMMENT(accept('*') && accept('/'));
+                IMPALA_SKIP_COMMENT(scan::find_comment_end, 2);
                 continue;
             }
             if (accept('/')) { // end of line comment
-                IMPALA_WITHIN_COMMENT(accept('\n'));
+                IMPALA_SKIP_COMMENT(scan::find_nl, 1);
                 continue;
             }
             return {loc(), Token::DIV};
@@ -169,61 +186,59 @@ Token Lexer::lex() {
         if (accept('}')) return {loc(), Token::R_BRACE};
         if (accept('~')) return {loc(), Token::TILDE};
         if (accept('?')) return {loc(), Token::KNOWN};
+        if (accept('#')) return {loc(), Token::HASH};
 
         // '.', floats
         if (accept('.')) {
-            str += '.';
-            if (accept(str, dec)) goto l_fractional_dot_rest;
-            if (accept('.'))      return {loc(), Token::DOTDOT};
+            if (accept(dec)) goto l_fractional_dot_rest;
+            if (accept('.')) return {loc(), Token::DOTDOT};
             return {loc(), Token::DOT};
         }
 
         // identifiers/keywords
-        if (lex_identifier(str))
-            return {loc(), str};
+        if (lex_identifier())
+            return {loc(), spelling(begin)};
 
         // char literal
-        if (accept(str , '\'')) {
-            while (!accept(str, '\'')) {
-                accept(str, '\\');
-                str += next();
+        if (accept('\'')) {
+            while (!accept('\'')) {
+                accept('\\');
+                next();
                 if (peek() == std::istream::traits_type::eof()) {
                     error(curr(), "missing terminating ' character");
-                    str += '\''; // artificially append closing '
                     break;
                 }
             }
-            return {loc(), Token::LIT_char, str};
+            return {loc(), Token::LIT_char, spelling(begin)};
         }
 
         // string literal
-        if (accept(str , '"')) {
-             while (!accept(str, '"')) {
-                accept(str, '\\');
-                str += next();
+        if (accept('"')) {
+             while (!accept('"')) {
+                accept('\\');
+                next();
                 if (peek() == std::istream::traits_type::eof()) {
                     error(curr(), "missing terminating \" character");
-                    str += '\''; // artificially append closing "
                     break;
                 }
             }
-            return {loc(), Token::LIT_str, str};
+            return {loc(), Token::LIT_str, spelling(begin)};
         }
 
         /*
          * literals
          */
 
-        if (accept(str, dec_nonzero)) goto l_dec;
-        if (accept(str, '0')) {
+        if (accept(dec_nonzero)) goto l_dec;
+        if (accept('0')) {
 #define IMPALA_LEX_BASE_NUM(prefix, pred) \
-            if (accept(str, (prefix))) { \
-                while (accept(str, '_')) {} \
-                if (accept(str, (pred))) { \
-                    while (accept(str, (pred)) || accept(str, '_')) {} \
-                    return lex_suffix(str, false); \
+            if (accept(prefix)) { \
+                while (accept('_')) {} \
+                if (accept(pred)) { \
+                    while (accept(pred) || accept('_')) {} \
+                    return lex_suffix(begin, false); \
                 } \
-                return literal_error(str, false); \
+                return literal_error(begin, false); \
             }
 
             IMPALA_LEX_BASE_NUM('b', bin)
@@ -237,67 +252,67 @@ Token Lexer::lex() {
         continue;
 
 l_dec:                                      // [0-9_]*
-        while (accept(str, dec) || accept(str, '_')) {}
-        if (accept(str, '.')) {             // [0-9]
-            if (accept(str, dec)) goto l_fractional_dot_rest;
-            if (accept(str,  eE)) goto l_exp;
-            return lex_suffix(str, true);
+        lex_dec();
+        if (accept('.')) {                  // [0-9]
+            if (accept(dec)) goto l_fractional_dot_rest;
+            if (accept(eE))  goto l_exp;
+            return lex_suffix(begin, true);
         }
-        if (accept(str,  eE)) goto l_exp;
-        return lex_suffix(str, false);
+        if (accept(eE)) goto l_exp;
+        return lex_suffix(begin, false);
 
 l_fractional_dot_rest:                      // [0-9_]*
-        while (accept(str, dec) || accept(str, '_')) {}
-        if (accept(str,  eE)) goto l_exp;
-        return lex_suffix(str, true);
+        lex_dec();
+        if (accept(eE)) goto l_exp;
+        return lex_suffix(begin, true);
 
 l_exp:                                      // [eE][+-]?[0-9_]+
-        accept(str, sgn);
-        if (accept(str, dec) || accept(str, '_')) {
-            while (accept(str, dec) || accept(str, '_')) {}
-            return lex_suffix(str, true);
+        accept(sgn);
+        if (dec(peek()) || peek() == '_') {
+            lex_dec();
+            return lex_suffix(begin, true);
         }
-        return literal_error(str, true);
+        return literal_error(begin, true);
     }
 }
 
-bool Lexer::lex_identifier(std::string& str) {
-    if (accept(str, sym)) {
-        while (accept(str, sym) || accept(str, dec)) {}
+bool Lexer::lex_identifier() {
+    if (sym(peek())) {
+        skip(scan::skip_sym(ptr_ + 1, end_));
         return true;
     }
     return false;
 }
 
-Token Lexer::lex_suffix(std::string& str, bool floating) {
+Token Lexer::lex_suffix(const char* begin, bool floating) {
     TokenTag tok = floating ? Token::LIT_f64 : Token::LIT_i32;
-    std::string suffix_str;
-    if (lex_identifier(suffix_str)) {
-        Symbol suffix(suffix_str);
+    auto number_end = ptr_;
+    if (lex_identifier()) {
+        Symbol suffix(std::string_view(number_end, ptr_ - number_end));
+        auto number = std::string_view(begin, number_end - begin);
         if (floating) {
             auto lit = Token::sym2flit(suffix);
             if (lit == Token::Error) {
                 error(loc(), "invalid suffix on floating constant '{}'", suffix);
-                return {loc(), tok, str};
+                return {loc(), tok, number};
             }
             tok = lit;
         } else {
             auto lit = Token::sym2lit(suffix);
             if (lit == Token::Error) {
                 error(loc(), "invalid suffix on constant '{}'", suffix);
-                return {loc(), tok, str};
+                return {loc(), tok, number};
             }
             tok = lit;
         }
-        str += suffix.c_str();
     }
 
-    return {loc(), tok, str};
+    return {loc(), tok, spelling(begin)};
 }
 
-Token Lexer::literal_error(std::string& str, bool floating) {
-    error(loc(), "invalid constant '{}'", str);
-    return lex_suffix(str, floating);
+Token Lexer::literal_error(const char* begin, bool floating) {
+    error(loc(), "invalid constant '{}'", std::string(spelling(begin)));
+    return lex_suffix(begin, floating);
 }
 
 }
@@ -2,36 +2,37 @@
 #define IMPALA_LEXER_H
 
 #include <istream>
+#include <memory>
 
 #include "impala/loc.h"
+#include "impala/source.h"
 #include "impala/token.h"
 
 namespace impala {
 
 class Lexer {
 public:
+    /// Scans the contiguous buffer of @p source which must outlive this @p Lexer.
+    Lexer(const Source& source);
+    /// Fallback for non-mappable input: buffers the whole @p stream first.
     Lexer(std::istream& stream, const char* filename);
 
     Token lex(); ///< Get next \p Token in stream.
+    Loc start() const { return {base_, base_}; } ///< Location of the first character.
 
 private:
-    bool lex_identifier(std::string&);
-    Token lex_suffix(std::string&, bool floating);
-    Token literal_error(std::string&, bool floating);
+    bool lex_identifier();
+    Token lex_suffix(const char* begin, bool floating);
+    Token literal_error(const char* begin, bool floating);
     int next();
-    int peek() const { return stream_.peek(); }
-    Loc loc() const { return {filename_, front_line_, front_col_, back_line_, back_col_}; }
+    void skip(const char* to);
+    void lex_dec();
+    int peek() const { return ptr_ != end_ ? (unsigned char) *ptr_ : std::istream::traits_type::eof(); }
+    std::string_view spelling(const char* begin) const { return {begin, size_t(ptr_ - begin)}; }
+    Loc loc() const { return {offset(front_), offset(back_)}; }
+    uint32_t offset(const char* p) const { return base_ + uint32_t(p - begin_); }
     Loc curr() const { return loc().back(); }
 
-    template<class Pred>
-    bool accept(std::string& str, Pred pred) {
-        if (pred(peek())) {
-            str += next();
-            return true;
-        }
-        return false;
-    }
-
     template<class Pred>
     bool accept(Pred pred) {
         if (pred(peek())) {
@@ -42,13 +43,16 @@ private:
     }
 
     bool accept(int expect) { return accept([&] (int got) { return got == expect; }); }
-    bool accept(std::string& str, int expect) { return accept(str, [&] (int got) { return got == expect; }); }
     bool accept(char c) { return accept((int) c); }
-    bool accept(std::string& str, char c) { return accept(str, (int) c); }
 
-    std::istream& stream_;
+    std::unique_ptr<Source> buffered_; ///< Only set when lexing from a @c std::istream.
     const char* filename_;
-    uint32_t front_line_ = 1, front_col_ = 1, back_line_ = 1, back_col_ = 1, peek_line_ = 1, peek_col_ = 1;
+    const char* begin_;
+    const char* ptr_;
+    const char* end_;
+    const char* front_; ///< First character of the current token.
+    const char* back_;  ///< Last character consumed.
+    uint32_t base_;     ///< @p Loc offset of @p begin_.
 };
 
 }
@@ -1,33 +1,140 @@
 #include "impala/loc.h"
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 #include "thorin/util/stream.h"
 
+#include "impala/scan.h"
+
 namespace impala {
 
-Loc operator+(Loc l1, Loc l2) {
-    return {l1.filename(), l1.front_line(), l1.front_col(), l2.back_line(), l2.back_col()};
+namespace {
+
+struct File {
+    std::string filename;
+    uint32_t base;                 ///< Offset of the first character.
+    std::vector<uint32_t> lines;   ///< Offsets relative to @p base where a line begins; the first one is 0.
+};
+
+/**
+ * Registering a file publishes a new immutable list of all files; thus, resolving a location never takes a lock.
+ * Files and lists are only freed at exit since a resolving thread may still look at an outdated list.
+ */
+class FileTable {
+public:
+    static FileTable& get() {
+        static FileTable table;
+        return table;
+    }
+
+    uint32_t add(const char* filename, std::string_view contents) {
+        auto file = std::make_unique<File>();
+        file->filename = filename;
+        file->lines.push_back(0);
+        for (auto p = contents.data(), end = p + contents.size(); (p = scan::find_nl(p, end)) != end;)
+            file->lines.push_back(uint32_t(++p - contents.data()));
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        // the EOF position one past the last character needs an offset, too
+        if (uint64_t(next_) + contents.size() + 1 > std::numeric_limits<uint32_t>::max())
+            throw std::runtime_error("input files exceed the 4 GiB limit of source locations");
+        file->base = next_;
+        next_ += uint32_t(contents.size()) + 1;
+        auto list = std::make_unique<FileList>(lists_.empty() ? FileList() : *lists_.back());
+        list->push_back(file.get());
+        files_.emplace_back(std::move(file));
+        lists_.emplace_back(std::move(list));
+        list_.store(lists_.back().get(), std::memory_order_release);
+        return files_.back()->base;
+    }
+
+    uint32_t base(const char* filename) {
+        if (auto list = list_.load(std::memory_order_acquire)) {
+            for (auto i = list->rbegin(), e = list->rend(); i != e; ++i) {
+                if ((*i)->filename == filename)
+                    return (*i)->base;
+            }
+        }
+        return 0;
+    }
+
+    /// Resolves @p offset to a @p File and 1-based line and column.
+    const File* find(uint32_t offset, uint32_t& line, uint32_t& col) {
+        auto list = list_.load(std::memory_order_acquire);
+        if (list == nullptr)
+            return nullptr;
+        auto i = std::upper_bound(list->begin(), list->end(), offset, [](uint32_t o, const File* f) { return o < f->base; });
+        if (i == list->begin())
+            return nullptr;
+        auto file = *--i;
+
+        auto rel = offset - file->base;
+        auto l = std::upper_bound(file->lines.begin(), file->lines.end(), rel) - 1;
+        line = uint32_t(l - file->lines.begin()) + 1;
+        col  = rel - *l + 1;
+        return file;
+    }
+
+private:
+    using FileList = std::vector<const File*>; ///< Sorted by @p File::base.
+
+    std::mutex mutex_; ///< Serializes @p add.
+    std::vector<std::unique_ptr<File>> files_;
+    std::vector<std::unique_ptr<FileList>> lists_;
+    std::atomic<const FileList*> list_ = nullptr; ///< The most recent one of @p lists_.
+    uint32_t next_ = 1;
+};
+
 }
 
-Stream& operator<<(Stream& os, Loc l) {
-#ifdef _MSC_VER
-    return os << l.filename() << "(" << l.front_line() << ")";
-#else // _MSC_VER
-    os << l.filename() << ':';
+uint32_t Loc::add_file(const char* filename, std::string_view contents) { return FileTable::get().add(filename, contents); }
+
+Loc Loc::file_start(const char* filename) {
+    auto base = FileTable::get().base(filename);
+    return {base, base};
+}
 
-    if (l.front_col() == uint16_t(-1) || l.back_col() == uint16_t(-1)) {
-        if (l.front_line() != l.back_line())
-            return os.fmt("{} - {}", l.front_line(), l.back_line());
-        else
-            return os.fmt("{}", l.front_line());
+Loc::Resolved Loc::resolve() const {
+    Resolved result = {"<unknown>", 1, 1, 1, 1};
+    if (!is_set())
+        return result;
+
+    auto& table = FileTable::get();
+    if (auto file = table.find(front_, result.front_line, result.front_col)) {
+        result.filename = file->filename.c_str();
+        if (back_ == front_) {
+            result.back_line = result.front_line;
+            result.back_col  = result.front_col;
+        } else {
+            table.find(back_, result.back_line, result.back_col);
+        }
     }
+    return result;
+}
+
+Loc operator+(Loc l1, Loc l2) { return {l1, l2}; }
+
+Stream& operator<<(Stream& os, Loc loc) {
+    auto l = loc.resolve();
+#ifdef _MSC_VER
+    return os << l.filename << "(" << l.front_line << ")";
+#else // _MSC_VER
+    os << l.filename << ':';
 
-    if (l.front_line() != l.back_line())
-        return os.fmt("{} col {} - {} col {}", l.front_line(), l.front_col(), l.back_line(), l.back_col());
+    if (l.front_line != l.back_line)
+        return os.fmt("{} col {} - {} col {}", l.front_line, l.front_col, l.back_line, l.back_col);
 
-    if (l.front_col() != l.back_col())
-        return os.fmt("{} col {} - {}", l.front_line(), l.front_col(), l.back_col());
+    if (l.front_col != l.back_col)
+        return os.fmt("{} col {} - {}", l.front_line, l.front_col, l.back_col);
 
-    return os.fmt("{} col {}", l.front_line(), l.front_col());
+    return os.fmt("{} col {}", l.front_line, l.front_col);
 #endif // _MSC_VER
 }
 
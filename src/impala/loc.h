@@ -1,43 +1,63 @@
 #ifndef IMPALA_LOC_H
 #define IMPALA_LOC_H
 
+#include <string_view>
+
 #include "thorin/util/stream.h"
 
 namespace impala {
 
 using thorin::Stream;
 
+/**
+ * Source location encoded as a pair of byte offsets into one global offset space.
+ * Each file registered via @p add_file occupies its own range in this space such that the offsets also identify the
+ * file.
+ * File name, line and column are only computed on demand from a per-file table of line starts - see @p resolve.
+ * @p front points to the first and @p back to the last character of the location.
+ */
 class Loc {
 public:
-    Loc() = default;
+    /// The result of @p resolve.
+    struct Resolved {
+        const char* filename;
+        uint32_t front_line, front_col, back_line, back_col;
+    };
 
-    Loc(const char* filename, uint32_t front_line, uint32_t front_col, uint32_t back_line, uint32_t back_col)
-        : filename_(filename)
-        , front_line_(front_line)
-        , front_col_(front_col)
-        , back_line_(back_line)
-        , back_col_(back_col)
-    {}
-    Loc(const char* filename, uint32_t line, uint32_t col)
-        : Loc(filename, line, col, line, col)
+    Loc() = default;
+    Loc(uint32_t front, uint32_t back)
+        : front_(front)
+        , back_(back)
     {}
     Loc(Loc front, Loc back)
-        : Loc(front.filename(), front.front_line(), front.front_col(), back.back_line(), back.back_col())
+        : Loc(front.front_, back.back_)
     {}
 
-    const char* filename() const { return filename_; }
-    uint32_t front_line() const { return front_line_; }
-    uint32_t front_col() const { return front_col_; }
-    uint32_t back_line() const { return back_line_; }
-    uint32_t back_col() const { return back_col_; }
+    /// Looks up file, lines and columns; this does not take any lock.
+    Resolved resolve() const;
+    const char* filename() const { return front().resolve().filename; }
+    uint32_t front_line() const { return front().resolve().front_line; }
+    uint32_t front_col() const { return front().resolve().front_col; }
+    uint32_t back_line() const { return resolve().back_line; }
+    uint32_t back_col() const { return resolve().back_col; }
+    uint32_t front_offset() const { return front_; }
+    uint32_t back_offset() const { return back_; }
+
+    Loc front() const { return {front_, front_}; }
+    Loc back() const { return {back_, back_}; }
+    bool is_set() const { return front_ != 0; }
 
-    Loc front() const { return {filename_, front_line(), front_col(), front_line(), front_col()}; }
-    Loc back() const { return {filename_, back_line(), back_col(), back_line(), back_col()}; }
-    bool is_set() const { return filename_ != nullptr; }
+    /**
+     * Registers a file named @p filename with @p contents and returns the offset of its first character.
+     * The line starts are recorded right away, so @p contents need not outlive the registration.
+     * Thread-safe.
+     */
+    static uint32_t add_file(const char* filename, std::string_view contents);
+    /// Location of the first character of the most recently registered file named @p filename.
+    static Loc file_start(const char* filename);
 
 protected:
-    const char* filename_ = nullptr; // TODO squeeze additional 4 * 4 bits out of the upper 16 bits
-    uint16_t front_line_ = 1, front_col_ = 1, back_line_ = 1, back_col_ = 1;
+    uint32_t front_ = 0, back_ = 0; ///< Offset 0 is never handed out and marks an unset @p Loc.
 };
 
 Loc operator+(Loc l1, Loc l2);
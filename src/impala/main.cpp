@@ -1,7 +1,15 @@
+#include <algorithm>
+#include <chrono>
+#include <ctime>
 #include <fstream>
 #include <vector>
 #include <cctype>
 #include <stdexcept>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
 
 #ifdef LLVM_SUPPORT
 #include "thorin/be/llvm/llvm.h"
@@ -15,6 +23,7 @@
 #include "impala/ast.h"
 #include "impala/cgen.h"
 #include "impala/impala.h"
+#include "impala/trace.h"
 
 using thorin::Stream;
 
@@ -24,6 +33,95 @@ typedef std::vector<std::string> Names;
 
 //------------------------------------------------------------------------------
 
+/// Wall and CPU time of each phase of a compiler run plus some counters; see @c -time-report, @c -stats and @c -stats-json.
+class Report {
+public:
+    /// Adds the lifetime of a @p Phase as phase @p name to @p report and to the @p impala::Trace.
+    class Phase {
+    public:
+        Phase(Report& report, const char* name)
+            : report_(report)
+            , name_(name)
+            , wall_(std::chrono::steady_clock::now())
+            , cpu_(std::clock())
+            , span_("phase", name)
+        {}
+        ~Phase() {
+            auto wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_).count();
+            auto cpu = double(std::clock() - cpu_) / CLOCKS_PER_SEC; // all threads of the process
+            report_.phases_.push_back({name_, wall, cpu});
+        }
+
+    private:
+        Report& report_;
+        const char* name_;
+        std::chrono::steady_clock::time_point wall_;
+        std::clock_t cpu_;
+        impala::Trace::Span span_;
+    };
+
+    void add(const char* name, uint64_t value) { stats_.emplace_back(name, value); }
+
+    void print_time_report() const {
+        double wall = 0.0, cpu = 0.0;
+        thorin::outf("time report:");
+        for (const auto& time : phases_) {
+            thorin::outf("    {}: {} s wall, {} s cpu", time.name, time.wall, time.cpu);
+            wall += time.wall;
+            cpu += time.cpu;
+        }
+        thorin::outf("    total: {} s wall, {} s cpu", wall, cpu);
+    }
+
+    void print_stats() const {
+        thorin::outf("statistics:");
+        for (const auto& [name, value] : stats_)
+            thorin::outf("    {}: {}", name, value);
+    }
+
+    /// Names are plain identifiers, so nothing needs to be escaped.
+    void write_json(std::ostream& os) const {
+        os << "{\n    \"phases\": [";
+        for (size_t i = 0, e = phases_.size(); i != e; ++i) {
+            os << (i == 0 ? "\n" : ",\n");
+            os << "        {\"name\": \"" << phases_[i].name << "\", \"wall\": " << phases_[i].wall << ", \"cpu\": " << phases_[i].cpu << "}";
+        }
+        os << "\n    ],\n    \"stats\": {";
+        for (size_t i = 0, e = stats_.size(); i != e; ++i) {
+            os << (i == 0 ? "\n" : ",\n");
+            os << "        \"" << stats_[i].first << "\": " << stats_[i].second;
+        }
+        os << "\n    }\n}\n";
+    }
+
+private:
+    struct Time {
+        const char* name;
+        double wall;
+        double cpu;
+    };
+
+    std::vector<Time> phases_;
+    std::vector<std::pair<const char*, uint64_t>> stats_;
+};
+
+/// Peak resident set size of the process in bytes or 0 if unknown.
+static uint64_t peak_rss() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return uint64_t(usage.ru_maxrss);        // bytes
+#else
+        return uint64_t(usage.ru_maxrss) * 1024; // KiB
+#endif
+    }
+#endif
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
 std::ostream* open(std::ofstream& stream, const std::string& name) {
     if (name == "-")
         return &std::cout;
@@ -43,10 +141,11 @@ int main(int argc, char** argv) {
         Names breakpoints;
         bool track_history;
 #endif
-        std::string out_name, log_name, log_level;
+        std::string out_name, log_name, log_level, jobs, stats_json, trace;
         bool help,
              emit_cint, emit_thorin, emit_ast, emit_annotated,
-             emit_llvm, opt_thorin, opt_s, opt_0, opt_1, opt_2, opt_3, debug, fancy;
+             emit_llvm, opt_thorin, opt_s, opt_0, opt_1, opt_2, opt_3, debug, fancy, ssa_locals, time_report, stats,
+             fast_math, fp_contract, no_signed_zeros, reciprocal_math, no_unsigned_wrap, check_overflow;
 
 #ifndef NDEBUG
 #define LOG_LEVELS "{error|warn|info|verbose|debug}"
@@ -64,6 +163,7 @@ int main(int argc, char** argv) {
             .add_option<bool>            ("track-history",      "", "track hisotry of names - useful for debugging", track_history, false)
 #endif
             .add_option<std::string>     ("o",                  "", "specifies the output module name", out_name, "")
+            .add_option<std::string>     ("j",                  "<N>", "parse input files, infer function bodies and check items on <N> threads; 0 uses all hardware threads", jobs, "1")
             .add_option<bool>            ("O0",                 "", "reduce compilation time and make debugging produce the expected results (default)", opt_0, false)
             .add_option<bool>            ("O1",                 "", "optimize", opt_1, false)
             .add_option<bool>            ("O2",                 "", "optimize even more", opt_2, false)
@@ -76,7 +176,18 @@ int main(int argc, char** argv) {
             .add_option<bool>            ("emit-llvm",          "", "emit llvm from Thorin representation (implies -Othorin)", emit_llvm, false)
             .add_option<bool>            ("emit-thorin",        "", "emit textual Thorin representation of Impala program", emit_thorin, false)
             .add_option<bool>            ("f",                  "", "use fancy output: Impala's AST dump uses only parentheses where necessary", fancy, false)
-            .add_option<bool>            ("g",                  "", "emit debug information", debug, false);
+            .add_option<bool>            ("fcheck-overflow",    "", "abort on integer overflows which would otherwise be undefined - including unsigned ones with -fno-unsigned-wrap", check_overflow, false)
+            .add_option<bool>            ("ffast-math",         "", "allow all floating-point optimizations which may change results, including the ones below", fast_math, false)
+            .add_option<bool>            ("ffp-contract",       "", "allow fusing floating-point multiplications and additions", fp_contract, false)
+            .add_option<bool>            ("fno-unsigned-wrap",  "", "assume that unsigned integer additions, subtractions and multiplications never wrap", no_unsigned_wrap, false)
+            .add_option<bool>            ("fno-signed-zeros",   "", "allow floating-point optimizations which ignore the sign of zero", no_signed_zeros, false)
+            .add_option<bool>            ("freciprocal-math",   "", "allow replacing floating-point divisions by multiplications with the reciprocal", reciprocal_math, false)
+            .add_option<bool>            ("g",                  "", "emit debug information", debug, false)
+            .add_option<bool>            ("ssa-locals",         "", "emit SSA values instead of stack slots for mutable locals of primitive type whose address is never taken", ssa_locals, false)
+            .add_option<bool>            ("time-report",        "", "print wall and CPU time of each compiler phase", time_report, false)
+            .add_option<bool>            ("stats",              "", "print token, AST node, type and Thorin def counts, type inference iterations, cache hits and peak memory", stats, false)
+            .add_option<std::string>     ("stats-json",         "<file>", "write the time report and the statistics as JSON to <file>; use '-' for stdout", stats_json, "")
+            .add_option<std::string>     ("trace",              "<file>", "write Chrome trace events of all phases and of the inference and emission of each function to <file>", trace, "");
 
         // do cmdline parsing
         cmd_parser.parse(argc, argv);
@@ -88,6 +199,12 @@ int main(int argc, char** argv) {
         if (opt_s + opt_0 + opt_1 + opt_2 + opt_3 > 1)
             throw std::invalid_argument("multiple optimization levels specified");
 
+        if (jobs.empty() || !std::all_of(jobs.begin(), jobs.end(), [] (char c) { return std::isdigit(c); }))
+            throw std::invalid_argument("number of threads must be a non-negative integer");
+        size_t num_threads = std::stoul(jobs);
+        if (num_threads == 0)
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+
         int opt = 0;
         if (opt_s) opt = -1;
         else if (opt_1) opt = 1;
@@ -166,26 +283,65 @@ int main(int argc, char** argv) {
         world.enable_history(track_history);
 #endif
 
+        // the AST - including nodes created during semantic analysis - lives in the arena owned by the module
+        auto arena = std::make_unique<impala::Arena>();
+        impala::Arena::Scope arena_scope(*arena);
+
+        if (!trace.empty())
+            impala::Trace::enable();
+
+        Report report;
         impala::Items items;
-        for (const auto& infile : infiles) {
-            auto filename = infile.c_str();
-            std::ifstream file(filename);
-            impala::parse(items, file, filename);
+        {
+            Report::Phase phase(report, "parse");
+            impala::parse(items, infiles, num_threads);
         }
 
-        auto module = std::make_unique<const impala::Module>(infiles.front().c_str(), std::move(items));
+        auto module = std::make_unique<const impala::Module>(infiles.front().c_str(), std::move(items), std::move(arena));
 
         if (emit_ast)
             module->dump();
 
+        // just like impala::check but each phase is measured on its own
         std::unique_ptr<impala::TypeTable> typetable;
-        impala::check(typetable, module.get());
+        {
+            Report::Phase phase(report, "name_analysis");
+            impala::name_analysis(module.get());
+        }
+        {
+            Report::Phase phase(report, "type_inference");
+            impala::type_inference(typetable, module.get(), num_threads);
+        }
+        {
+            Report::Phase phase(report, "type_analysis");
+            impala::type_analysis(module.get(), num_threads);
+        }
         bool result = impala::num_errors() == 0;
 
+        const auto& infer_stats = impala::infer_stats();
+        auto subtype_stats = typetable->subtype_stats();
+        auto instantiation_stats = typetable->instantiation_stats();
+        report.add("tokens",                impala::num_tokens());
+        report.add("ast_nodes",             impala::ASTNode::num_nodes());
+        report.add("types",                 typetable->num_types());
+        report.add("type_lookup_hits",      typetable->num_hits());
+        report.add("type_lookup_misses",    typetable->num_misses());
+        report.add("subtype_queries",       subtype_stats.queries);
+        report.add("subtype_memo_hits",     subtype_stats.hits);
+        report.add("instantiation_queries", instantiation_stats.queries);
+        report.add("instantiation_hits",    instantiation_stats.hits);
+        report.add("infer_units",           infer_stats.units);
+        report.add("infer_passes",          infer_stats.passes);
+        report.add("infer_rounds",          infer_stats.rounds);
+        report.add("infer_revisits",        infer_stats.revisits);
+        report.add("infer_isolated",        infer_stats.isolated);
+        report.add("infer_escaped",         infer_stats.escaped);
+
         if (emit_annotated)
             module->dump();
 
         if (result && emit_cint) {
+            Report::Phase phase(report, "c_interface");
             impala::CGenOptions opts;
 
             size_t pos = module_name.find_last_of("\\/");
@@ -209,18 +365,39 @@ int main(int argc, char** argv) {
             impala::generate_c_interface(module.get(), opts, out_file);
         }
 
-        if (result && (emit_llvm || emit_thorin))
-            impala::emit(world, module.get());
+        if (result && (emit_llvm || emit_thorin)) {
+            Report::Phase phase(report, "emit");
+            impala::EmitOptions options;
+            options.ssa = ssa_locals;
+            if (fast_math)       options.rmode |= thorin::RMode::fast;
+            if (fp_contract)     options.rmode |= thorin::RMode::contract;
+            if (no_signed_zeros) options.rmode |= thorin::RMode::nsz;
+            if (reciprocal_math) options.rmode |= thorin::RMode::arcp;
+            options.nuw = no_unsigned_wrap;
+            options.check_overflow = check_overflow;
+            impala::emit(world, module.get(), options);
+        }
 
         if (result) {
-            thorin::verify_mem(world);
-            thorin::cleanup(world);
-            if (opt_thorin)
+            report.add("thorin_defs_before_opt", world.defs().size());
+            {
+                Report::Phase phase(report, "verify_mem");
+                thorin::verify_mem(world);
+            }
+            {
+                Report::Phase phase(report, "cleanup");
+                thorin::cleanup(world);
+            }
+            if (opt_thorin) {
+                Report::Phase phase(report, "optimize");
                 optimize_old(world);
+            }
+            report.add("thorin_defs_after_opt", world.defs().size());
             if (emit_thorin)
                 world.dump();
             if (emit_llvm) {
 #ifdef LLVM_SUPPORT
+                Report::Phase phase(report, "llvm");
                 thorin::Backends backends(world);
                 auto emit_to_file = [&](thorin::CodeGen* cg, std::string ext) {
                     if (cg) {
@@ -243,10 +420,29 @@ int main(int argc, char** argv) {
                 thorin::outf("warning: built without LLVM support - I don't emit an LLVM file");
 #endif
             }
-        } else
-            return EXIT_FAILURE;
+        }
+
+        report.add("peak_rss_bytes", peak_rss());
+        if (time_report)
+            report.print_time_report();
+        if (stats)
+            report.print_stats();
+        if (!stats_json.empty()) {
+            std::ofstream json_stream;
+            auto json = open(json_stream, stats_json);
+            if (!*json)
+                throw std::runtime_error("cannot write '" + stats_json + "'");
+            report.write_json(*json);
+        }
+        if (!trace.empty()) {
+            std::ofstream trace_stream;
+            auto trace_out = open(trace_stream, trace);
+            if (!*trace_out)
+                throw std::runtime_error("cannot write '" + trace + "'");
+            impala::Trace::write(*trace_out);
+        }
 
-        return EXIT_SUCCESS;
+        return result ? EXIT_SUCCESS : EXIT_FAILURE;
     } catch (std::exception const& e) {
         thorin::errf("{}", e.what());
         return EXIT_FAILURE;
@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <functional>
 #include <sstream>
+#include <thread>
 
 #include "thorin/util/array.h"
 
@@ -108,17 +109,27 @@ class Parser;
 
 class Parser {
 public:
+    Parser(const Source& source)
+        : lexer_(source)
+    {
+        init();
+    }
     Parser(std::istream& stream, const char* filename)
         : lexer_(stream, filename)
     {
+        init();
+    }
+
+    void init() {
         lookahead_[0] = lexer_.lex();
         lookahead_[1] = lexer_.lex();
         lookahead_[2] = lexer_.lex();
-        prev_loc_ = Loc(filename, 1, 1, 1, 1);
+        prev_loc_ = lexer_.start();
     }
 
     const Token& lookahead(size_t i = 0) const { assert(i < 3); return lookahead_[i]; }
     Loc prev_loc() const { return prev_loc_; }
+    size_t num_tokens() const { return num_tokens_; } ///< Tokens consumed so far.
 
 #ifdef NDEBUG
     Token eat(TokenTag) { return lex(); }
@@ -180,7 +191,7 @@ public:
     Visibility parse_visibility();
     uint64_t parse_integer(const char* what);
     int parse_addr_space();
-    char char_value(const char*& p);
+    char char_value(const char*& p, const char* end);
 
     // paths
     const Path* parse_path();
@@ -212,12 +223,13 @@ public:
     enum class BodyMode { None, Optional, Mandatory };
 
     // items + helpers
-    const Item*        parse_item();
+    const Item*        parse_item(ArithAttrs = {});
     void               parse_items(Items&);
     const StaticItem*  parse_static_item(Tracker, Visibility);
     const EnumDecl*    parse_enum_decl(Tracker, Visibility);
     const OptionDecl*  parse_option_decl(const size_t);
-    const FnDecl*      parse_fn_decl(BodyMode, Tracker, Visibility, bool is_extern, Symbol abi);
+    const FnDecl*      parse_fn_decl(BodyMode, Tracker, Visibility, bool is_extern, Symbol abi, ArithAttrs = {});
+    ArithAttrs         parse_arith_attrs();
     const ImplItem*    parse_impl(Tracker, Visibility);
     const Item*        parse_module_or_module_decl(Tracker, Visibility);
     const Module*      parse_module();
@@ -245,9 +257,9 @@ public:
     const ForExpr*      parse_for_expr();
     const ForExpr*      parse_with_expr();
     const WhileExpr*    parse_while_expr();
-    const BlockExpr*    parse_block_expr();
+    const BlockExpr*    parse_block_expr(ArithAttrs = {});
     const RevDiffExpr*  parse_rev_diff_expr();
-    const BlockExpr*    try_block_expr(const std::string& context);
+    const BlockExpr*    try_block_expr(const std::string& context, ArithAttrs = {});
     const Expr*         parse_filter(const char* context);
 
     // patterns
@@ -259,7 +271,7 @@ public:
     const CharPtrn*    parse_char_ptrn();
 
     // statements
-    const ItemStmt* parse_item_stmt();
+    const ItemStmt* parse_item_stmt(ArithAttrs = {});
     const LetStmt*  parse_let_stmt();
     const AsmStmt*  parse_asm_stmt();
 
@@ -280,15 +292,94 @@ private:
     Lexer lexer_;        ///< invoked in order to get next token
     Token lookahead_[3]; ///< SLL(3) look ahead
     Loc prev_loc_;
+    size_t num_tokens_ = 0;
 };
 
 //------------------------------------------------------------------------------
 
-void parse(Items& items, std::istream& is, const char* filename) {
-    Parser parser(is, filename);
+static void parse(Items& items, Parser& parser) {
     parser.parse_items(items);
     if (parser.lookahead() != Token::Eof)
         parser.error("module item", "module contents");
+    num_tokens() += parser.num_tokens();
+}
+
+void parse(Items& items, const Source& source) {
+    Parser parser(source);
+    parse(items, parser);
+}
+
+void parse(Items& items, std::istream& is, const char* filename) {
+    Parser parser(is, filename);
+    parse(items, parser);
+}
+
+void parse(Items& items, ArrayRef<std::string> filenames, size_t num_threads) {
+    std::vector<std::unique_ptr<Source>> sources;
+    std::vector<const Source*> ptrs;
+    for (const auto& filename : filenames) {
+        sources.emplace_back(std::make_unique<Source>(filename.c_str()));
+        ptrs.emplace_back(sources.back().get());
+    }
+    parse(items, ptrs, num_threads);
+}
+
+/**
+ * Parses @p sources on up to @p num_threads threads.
+ * Each @p Source is parsed into its own @p Items with its own @p Arena and diagnostics buffer.
+ * Afterwards, the items are appended to @p items and the diagnostics are printed in the order of @p sources;
+ * the @p Arena%s are handed over to the @p Arena::current one.
+ */
+void parse(Items& items, ArrayRef<const Source*> sources, size_t num_threads) {
+    // register all files up front such that the Loc offsets do not depend on the schedule
+    for (auto source : sources)
+        source->base();
+
+    num_threads = std::min(num_threads, sources.size());
+    if (num_threads <= 1) {
+        for (auto source : sources)
+            parse(items, *source);
+        return;
+    }
+
+    struct Unit {
+        std::unique_ptr<Arena> arena = std::make_unique<Arena>(); // declared first to outlive items
+        Items items;
+        std::ostringstream diagnostics;
+        std::exception_ptr exception;
+    };
+
+    std::vector<Unit> units(sources.size());
+    std::atomic<size_t> next = 0;
+    auto work = [&] {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < units.size();) {
+            auto& unit = units[i];
+            Arena::Scope arena_scope(*unit.arena);
+            DiagnosticsScope diagnostics_scope(unit.diagnostics);
+            try {
+                parse(unit.items, *sources[i]);
+            } catch (...) {
+                unit.exception = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t != num_threads; ++t)
+        threads.emplace_back(work);
+    work();
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto& unit : units) {
+        diagnostics() << unit.diagnostics.str();
+        if (unit.exception)
+            std::rethrow_exception(unit.exception);
+        for (auto& item : unit.items)
+            items.emplace_back(std::move(item));
+        // without a current Arena, the items live until exit - just like everything allocated outside an Arena::Scope
+        Arena::adopt(std::move(*unit.arena));
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -303,6 +394,7 @@ Token Parser::lex() {
     lookahead_[1] = lookahead_[2]; // copy over LA3 to LA2
     lookahead_[2] = lexer_.lex();  // fill new LA3
     prev_loc_ = result.loc(); // remember previous loc
+    ++num_tokens_;
     return result;
 }
 
@@ -483,14 +575,16 @@ const Param* Parser::parse_return_param() {
  * items
  */
 
-const Item* Parser::parse_item() {
+const Item* Parser::parse_item(ArithAttrs arith_attrs) {
     auto tracker = track();
     auto vis = parse_visibility();
+    if (!arith_attrs.empty() && lookahead() != Token::FN)
+        error("function declaration", "item with arithmetic attributes");
 
     switch (lookahead()) {
         case Token::ENUM:    return parse_enum_decl(tracker, vis);
         case Token::EXTERN:  return parse_extern_block_or_fn_decl(tracker, vis);
-        case Token::FN:      return parse_fn_decl(BodyMode::Mandatory, tracker, vis, /*extern*/ false, /*abi*/ "");
+        case Token::FN:      return parse_fn_decl(BodyMode::Mandatory, tracker, vis, /*extern*/ false, /*abi*/ "", arith_attrs);
         case Token::IMPL:    return parse_impl(tracker, vis);
         case Token::MOD:     return parse_module_or_module_decl(tracker, vis);
         case Token::STATIC:  return parse_static_item(tracker, vis);
@@ -534,7 +628,7 @@ const Item* Parser::parse_extern_block_or_fn_decl(Tracker tracker, Visibility vi
 
     Symbol abi;
     if (lookahead() == Token::LIT_str)
-        abi = lex().symbol();
+        abi = lex().spelling();
 
     expect(Token::L_BRACE, "opening brace of external block");
     FnDecls fn_decls;
@@ -545,9 +639,9 @@ const Item* Parser::parse_extern_block_or_fn_decl(Tracker tracker, Visibility vi
     return new ExternBlock(tracker, vis, abi, std::move(fn_decls));
 }
 
-const FnDecl* Parser::parse_fn_decl(BodyMode mode, Tracker tracker, Visibility vis, bool is_extern, Symbol abi) {
+const FnDecl* Parser::parse_fn_decl(BodyMode mode, Tracker tracker, Visibility vis, bool is_extern, Symbol abi, ArithAttrs arith_attrs) {
     eat(Token::FN);
-    auto export_name = lookahead() == Token::LIT_str ? lex().symbol() : Symbol();
+    auto export_name = lookahead() == Token::LIT_str ? Symbol(lex().spelling()) : Symbol();
 
     const Expr* filter = parse_filter("partial evaluation filter of function declaration");
     auto identifier = try_identifier("function name");
@@ -560,10 +654,10 @@ const FnDecl* Parser::parse_fn_decl(BodyMode mode, Tracker tracker, Visibility v
     const Expr* body = nullptr;
     switch (mode) {
         case BodyMode::None:      expect(Token::SEMICOLON, "function declaration"); break;
-        case BodyMode::Mandatory: body = try_block_expr("body of function"); break;
+        case BodyMode::Mandatory: body = try_block_expr("body of function", arith_attrs); break;
         case BodyMode::Optional:
             if (!accept(Token::SEMICOLON))
-                body = try_block_expr("body of function");
+                body = try_block_expr("body of function", arith_attrs);
             break;
     }
 
@@ -571,6 +665,28 @@ const FnDecl* Parser::parse_fn_decl(BodyMode mode, Tracker tracker, Visibility v
                       std::move(ast_type_params), std::move(params), body);
 }
 
+/// Parses any number of <tt>#[attr, ...]</tt> lists of arithmetic attributes.
+ArithAttrs Parser::parse_arith_attrs() {
+    ArithAttrs arith_attrs;
+    while (accept(Token::HASH)) {
+        expect(Token::L_BRACKET, "arithmetic attributes");
+        parse_comma_list("closing bracket of arithmetic attributes", Token::R_BRACKET, [&] {
+            auto tok = lookahead();
+            if (!expect(Token::ID, "arithmetic attribute")) return;
+            auto symbol = tok.symbol();
+            if      (symbol == syms::fast_math)        arith_attrs.rmode |= RMode::fast;
+            else if (symbol == syms::fp_contract)      arith_attrs.rmode |= RMode::contract;
+            else if (symbol == syms::no_signed_zeros)  arith_attrs.rmode |= RMode::nsz;
+            else if (symbol == syms::reciprocal_math)  arith_attrs.rmode |= RMode::arcp;
+            else if (symbol == syms::fp_strict)        arith_attrs.strict = true;
+            else if (symbol == syms::no_unsigned_wrap) arith_attrs.nuw = true;
+            else if (symbol == syms::unsigned_wrap)    arith_attrs.wrap = true;
+            else error("'fast_math', 'fp_contract', 'no_signed_zeros', 'reciprocal_math', 'fp_strict', 'no_unsigned_wrap' or 'unsigned_wrap'", "arithmetic attributes", tok);
+        });
+    }
+    return arith_attrs;
+}
+
 const ImplItem* Parser::parse_impl(Tracker tracker, Visibility vis) {
     eat(Token::IMPL);
     auto ast_type_params = parse_ast_type_params();
@@ -584,8 +700,14 @@ const ImplItem* Parser::parse_impl(Tracker tracker, Visibility vis) {
         ast_type = type;
     expect(Token::L_BRACE, "impl");
     FnDecls methods;
-    while (lookahead() == Token::FN)
-        methods.emplace_back(parse_fn_decl(BodyMode::Mandatory, tracker, vis, /*exter*/ false, /*abi*/ ""));
+    while (lookahead() == Token::FN || lookahead() == Token::HASH) {
+        auto arith_attrs = parse_arith_attrs();
+        if (lookahead() != Token::FN) {
+            error("method", "impl");
+            break;
+        }
+        methods.emplace_back(parse_fn_decl(BodyMode::Mandatory, tracker, vis, /*exter*/ false, /*abi*/ "", arith_attrs));
+    }
     expect(Token::R_BRACE, "closing brace of impl");
 
     return new ImplItem(tracker, vis, std::move(ast_type_params), trait, ast_type, std::move(methods));
@@ -613,6 +735,15 @@ void Parser::parse_items(Items& items) {
             case ITEM:
                 items.emplace_back(parse_item());
                 continue;
+            case Token::HASH: {
+                auto arith_attrs = parse_arith_attrs();
+                switch (lookahead()) {
+                    case VISIBILITY:
+                    case ITEM: items.emplace_back(parse_item(arith_attrs)); break;
+                    default:   error("function declaration", "item with arithmetic attributes");
+                }
+                continue;
+            }
             case Token::SEMICOLON:
                 lex();
                 continue;
@@ -668,8 +799,14 @@ const TraitDecl* Parser::parse_trait_decl(Tracker tracker, Visibility vis) {
 
     expect(Token::L_BRACE, "trait declaration");
     FnDecls methods;
-    while (lookahead() == Token::FN)
-        methods.emplace_back(parse_fn_decl(BodyMode::Optional, tracker, vis, /*exter*/ false, /*abi*/ ""));
+    while (lookahead() == Token::FN || lookahead() == Token::HASH) {
+        auto arith_attrs = parse_arith_attrs();
+        if (lookahead() != Token::FN) {
+            error("method", "trait declaration");
+            break;
+        }
+        methods.emplace_back(parse_fn_decl(BodyMode::Optional, tracker, vis, /*exter*/ false, /*abi*/ "", arith_attrs));
+    }
     expect(Token::R_BRACE, "closing brace of trait declaration");
 
     return new TraitDecl(tracker, vis, identifier, std::move(ast_type_params), std::move(super_traits), std::move(methods));
@@ -1001,6 +1138,10 @@ const Expr* Parser::parse_primary_expr() {
         case Token::WITH:          return parse_with_expr();
         case Token::WHILE:         return parse_while_expr();
         case Token::L_BRACE:       return parse_block_expr();
+        case Token::HASH: {
+            auto arith_attrs = parse_arith_attrs();
+            return try_block_expr("expression with arithmetic attributes", arith_attrs);
+        }
         case Token::REV_DIFF:      return parse_rev_diff_expr();
         default:                   error("expression", ""); return new EmptyExpr(lex().loc());
     }
@@ -1023,9 +1164,13 @@ const LiteralExpr* Parser::parse_literal_expr() {
     }
 }
 
-char Parser::char_value(const char*& p) {
+char Parser::char_value(const char*& p, const char* end) {
     char value = 0;
     if (*p++ == '\\') {
+        if (p == end) {
+            impala::error(lookahead().loc(), "expected valid escape sequence while parsing {}", lookahead());
+            return value;
+        }
         switch (*p++) {
         case '0':  value = '\0'; break;
         case 'n':  value = '\n'; break;
@@ -1044,42 +1189,46 @@ char Parser::char_value(const char*& p) {
 }
 
 const CharExpr* Parser::parse_char_expr() {
-    auto symbol = lookahead().symbol();
-    const char* p = symbol.c_str();
+    auto spelling = lookahead().spelling();
+    const char* p = spelling.data();
+    const char* end = p + spelling.size();
     assert(*p == '\'');
     ++p;
     char value = 0;
-    if (*p != '\'') {
-        value = char_value(p);
+    if (p != end && *p != '\'') {
+        value = char_value(p, end);
 
-        if (*p++ != '\'')
+        // the lexer already complained about a missing terminating '
+        if (p != end && *p++ != '\'')
             error("single character", "character constant");
         else
-            assert(*p == '\0');
+            assert(p == end);
     } else
         error("a character", "character constant");
 
-    return new CharExpr(lex().loc(), symbol, value);
+    return new CharExpr(lex().loc(), std::string(spelling), value);
 }
 
 const StrExpr* Parser::parse_str_expr() {
     auto tracker = track();
-    Symbols symbols;
+    Strings spellings;
     std::vector<char> values;
     do {
-       symbols.emplace_back(lookahead().symbol());
+        auto spelling = lookahead().spelling();
+        spellings.emplace_back(spelling);
 
-        const char* p = symbols.back().c_str();
+        const char* p = spelling.data();
+        const char* end = p + spelling.size();
         assert(*p == '"');
         ++p;
-        while (*p != '"')
-            values.emplace_back(char_value(p));
-        assert(p[1] == '\0');
+        while (p != end && *p != '"')
+            values.emplace_back(char_value(p, end));
+        assert(p == end || p + 1 == end);
         lex();
     } while (lookahead() == Token::LIT_str);
     values.emplace_back('\0');
 
-    return new StrExpr(tracker, std::move(symbols), std::move(values));
+    return new StrExpr(tracker, std::move(spellings), std::move(values));
 }
 
 const FnExpr* Parser::parse_fn_expr(bool nested) {
@@ -1189,12 +1338,23 @@ const WhileExpr* Parser::parse_while_expr() {
     return new WhileExpr(tracker, continue_decl, cond, body, break_decl);
 }
 
-const BlockExpr* Parser::parse_block_expr() {
+const BlockExpr* Parser::parse_block_expr(ArithAttrs arith_attrs) {
     auto tracker = track();
     eat(Token::L_BRACE);
     Stmts stmts;
     const Expr* final_expr = nullptr;
     while (true) {
+        // attributes of either a nested function or a nested block
+        ArithAttrs nested_attrs;
+        if (lookahead() == Token::HASH) {
+            nested_attrs = parse_arith_attrs();
+            switch (lookahead()) {
+                case Token::L_BRACE: break;
+                case ITEM: stmts.emplace_back(parse_item_stmt(nested_attrs)); continue;
+                default:   error("block expression or function declaration", "arithmetic attributes");
+            }
+        }
+
         switch (lookahead()) {
             case Token::SEMICOLON: lex(); continue; // ignore semicolon
             case ITEM:             stmts.emplace_back(parse_item_stmt()); continue;
@@ -1210,7 +1370,7 @@ const BlockExpr* Parser::parse_block_expr() {
                     case Token::FOR:           expr = parse_for_expr(); break;
                     case Token::WITH:          expr = parse_with_expr(); break;
                     case Token::WHILE:         expr = parse_while_expr(); break;
-                    case Token::L_BRACE:       expr = parse_block_expr(); break;
+                    case Token::L_BRACE:       expr = parse_block_expr(nested_attrs); break;
                     case Token::REV_DIFF:      expr = parse_rev_diff_expr(); break;
                     default:                   expr = parse_expr(); stmt_like = false;
                 }
@@ -1227,15 +1387,15 @@ const BlockExpr* Parser::parse_block_expr() {
                 expect(Token::R_BRACE, "block expression");
                 if (final_expr == nullptr)
                     final_expr = create<EmptyExpr>();
-                return new BlockExpr(tracker, std::move(stmts), final_expr);
+                return new BlockExpr(tracker, std::move(stmts), final_expr, arith_attrs);
         }
     }
 }
 
-const BlockExpr* Parser::try_block_expr(const std::string& context) {
+const BlockExpr* Parser::try_block_expr(const std::string& context, ArithAttrs arith_attrs) {
     switch (lookahead()) {
         case Token::L_BRACE:
-            return parse_block_expr();
+            return parse_block_expr(arith_attrs);
         default:
             error("block expression", context);
             return create<BlockExpr>();
@@ -1349,9 +1509,9 @@ const LetStmt* Parser::parse_let_stmt() {
     return new LetStmt(tracker, ptrn, init);
 }
 
-const ItemStmt* Parser::parse_item_stmt() {
+const ItemStmt* Parser::parse_item_stmt(ArithAttrs arith_attrs) {
     auto tracker = track();
-    auto item = parse_item();
+    auto item = parse_item(arith_attrs);
     return new ItemStmt(tracker, item);
 }
 
@@ -1406,14 +1566,17 @@ out:
 std::string Parser::parse_str() {
     std::string str;
     do {
-        std::string res = lookahead().symbol().c_str() + 1;
+        auto res = lookahead().spelling().substr(1);
+        // an unterminated string at the end of the file lacks the closing quote
+        if (!res.empty() && res.back() == '"') res.remove_suffix(1);
         // replaces special characters
-        for (size_t i = 0; i < res.length() - 1; ++i) {
+        for (size_t i = 0; i < res.size(); ++i) {
             if (res[i] != '\\') {
                 str += res[i];
                 continue;
             }
-            switch (res[++i]) {
+            if (++i == res.size()) break;
+            switch (res[i]) {
                 case 'n': str += '\n'; break;
                 case 't': str += '\t'; break;
                 case 'r': str += '\r'; break;
@@ -0,0 +1,157 @@
+#include "impala/scan.h"
+
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define IMPALA_SCAN_X86 1
+#include <immintrin.h>
+#else
+#define IMPALA_SCAN_X86 0
+#endif
+
+namespace impala::scan {
+
+/*
+ * scalar
+ */
+
+static inline bool is_space(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+static inline bool is_dec(char c) { return (c >= '0' && c <= '9') || c == '_'; }
+static inline bool is_sym(char c) { return is_dec(c) || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z'); }
+
+static const char* skip_space_scalar(const char* p, const char* end) { while (p != end && is_space(*p)) ++p; return p; }
+static const char* skip_sym_scalar(const char* p, const char* end) { while (p != end && is_sym(*p)) ++p; return p; }
+static const char* skip_dec_scalar(const char* p, const char* end) { while (p != end && is_dec(*p)) ++p; return p; }
+static const char* find_nl_scalar(const char* p, const char* end) { while (p != end && *p != '\n') ++p; return p; }
+
+static const char* find_comment_end_scalar(const char* p, const char* end) {
+    for (; p != end; ++p) {
+        if (p[0] == '*' && p + 1 != end && p[1] == '/')
+            return p;
+    }
+    return end;
+}
+
+#if IMPALA_SCAN_X86
+
+/*
+ * Byte classes are computed with signed compares: bytes >= 0x80 are negative and thus never in any of our ranges.
+ * The skip_* scanners look for the first byte @em not in the class, the find_* scanners for the first byte in it.
+ */
+
+#define IMPALA_SCAN_RANGE(pre, si, v, lo, hi) \
+    pre##_and_si##si(pre##_cmpgt_epi8(v, pre##_set1_epi8((lo) - 1)), pre##_cmpgt_epi8(pre##_set1_epi8((hi) + 1), v))
+#define IMPALA_SCAN_EQ(pre, si, v, c) pre##_cmpeq_epi8(v, pre##_set1_epi8(c))
+
+#define IMPALA_SCAN_SPACE(pre, si, v) pre##_or_si##si(IMPALA_SCAN_EQ(pre, si, v, ' '), IMPALA_SCAN_RANGE(pre, si, v, '\t', '\r'))
+#define IMPALA_SCAN_DEC(pre, si, v)   pre##_or_si##si(IMPALA_SCAN_EQ(pre, si, v, '_'), IMPALA_SCAN_RANGE(pre, si, v, '0', '9'))
+#define IMPALA_SCAN_SYM(pre, si, v)   pre##_or_si##si(IMPALA_SCAN_DEC(pre, si, v), \
+                                IMPALA_SCAN_RANGE(pre, si, pre##_or_si##si(v, pre##_set1_epi8(0x20)), 'a', 'z'))
+
+#define IMPALA_SCAN_SKIP(name, isa, target, pre, si, vec, n, loadu, all, CLASS) \
+    target static const char* name##_##isa(const char* p, const char* end) { \
+        for (; end - p >= n; p += n) { \
+            auto v = loadu((const vec*) p); \
+            auto mask = uint32_t(pre##_movemask_epi8(CLASS(pre, si, v))); \
+            if (mask != all) \
+                return p + __builtin_ctz(~mask); \
+        } \
+        return name##_scalar(p, end); \
+    }
+
+#define IMPALA_SCAN_SCANNERS(isa, target, pre, si, vec, n, loadu, all) \
+    IMPALA_SCAN_SKIP(skip_space, isa, target, pre, si, vec, n, loadu, all, IMPALA_SCAN_SPACE) \
+    IMPALA_SCAN_SKIP(skip_sym,   isa, target, pre, si, vec, n, loadu, all, IMPALA_SCAN_SYM) \
+    IMPALA_SCAN_SKIP(skip_dec,   isa, target, pre, si, vec, n, loadu, all, IMPALA_SCAN_DEC) \
+    \
+    target static const char* find_nl_##isa(const char* p, const char* end) { \
+        for (; end - p >= n; p += n) { \
+            auto v = loadu((const vec*) p); \
+            if (auto mask = uint32_t(pre##_movemask_epi8(IMPALA_SCAN_EQ(pre, si, v, '\n')))) \
+                return p + __builtin_ctz(mask); \
+        } \
+        return find_nl_scalar(p, end); \
+    } \
+    \
+    target static const char* find_comment_end_##isa(const char* p, const char* end) { \
+        /* we also load p + 1 and, thus, need one more byte */ \
+        for (; end - p > n; p += n) { \
+            auto star  = IMPALA_SCAN_EQ(pre, si, loadu((const vec*) p), '*'); \
+            auto slash = IMPALA_SCAN_EQ(pre, si, loadu((const vec*) (p + 1)), '/'); \
+            if (auto mask = uint32_t(pre##_movemask_epi8(pre##_and_si##si(star, slash)))) \
+                return p + __builtin_ctz(mask); \
+        } \
+        return find_comment_end_scalar(p, end); \
+    }
+
+IMPALA_SCAN_SCANNERS(sse2, __attribute__((target("sse2"))), _mm, 128, __m128i, 16, _mm_loadu_si128, 0xFFFFu)
+IMPALA_SCAN_SCANNERS(avx2, __attribute__((target("avx2"))), _mm256, 256, __m256i, 32, _mm256_loadu_si256, 0xFFFFFFFFu)
+
+#endif // IMPALA_SCAN_X86
+
+/*
+ * dispatch
+ */
+
+struct Scanners {
+    ISA isa;
+    const char* (*skip_space)(const char*, const char*);
+    const char* (*skip_sym)(const char*, const char*);
+    const char* (*skip_dec)(const char*, const char*);
+    const char* (*find_nl)(const char*, const char*);
+    const char* (*find_comment_end)(const char*, const char*);
+};
+
+#define IMPALA_SCAN_TABLE(isa, ISA) { ISA, skip_space_##isa, skip_sym_##isa, skip_dec_##isa, find_nl_##isa, find_comment_end_##isa }
+
+static const Scanners scalar_scanners = IMPALA_SCAN_TABLE(scalar, ISA::Scalar);
+#if IMPALA_SCAN_X86
+static const Scanners sse2_scanners = IMPALA_SCAN_TABLE(sse2, ISA::SSE2);
+static const Scanners avx2_scanners = IMPALA_SCAN_TABLE(avx2, ISA::AVX2);
+#endif
+
+ISA best_isa() {
+#if IMPALA_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return ISA::AVX2;
+    if (__builtin_cpu_supports("sse2")) return ISA::SSE2;
+#endif
+    return ISA::Scalar;
+}
+
+static const Scanners* isa2scanners(ISA isa) {
+    switch (isa) {
+#if IMPALA_SCAN_X86
+        case ISA::AVX2: return &avx2_scanners;
+        case ISA::SSE2: return &sse2_scanners;
+#endif
+        default:        return &scalar_scanners;
+    }
+}
+
+static const Scanners* scanners = isa2scanners(best_isa());
+
+bool set_isa(ISA isa) {
+    if (int(isa) > int(best_isa()))
+        return false;
+    scanners = isa2scanners(isa);
+    return true;
+}
+
+ISA isa() { return scanners->isa; }
+
+const char* isa2str(ISA isa) {
+    switch (isa) {
+        case ISA::AVX2: return "avx2";
+        case ISA::SSE2: return "sse2";
+        default:        return "scalar";
+    }
+}
+
+const char* skip_space(const char* p, const char* end) { return scanners->skip_space(p, end); }
+const char* skip_sym(const char* p, const char* end) { return scanners->skip_sym(p, end); }
+const char* skip_dec(const char* p, const char* end) { return scanners->skip_dec(p, end); }
+const char* find_nl(const char* p, const char* end) { return scanners->find_nl(p, end); }
+const char* find_comment_end(const char* p, const char* end) { return scanners->find_comment_end(p, end); }
+
+}
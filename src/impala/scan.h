@@ -0,0 +1,28 @@
+#ifndef IMPALA_SCAN_H
+#define IMPALA_SCAN_H
+
+namespace impala::scan {
+
+/**
+ * Vectorized scanners used by the @p Lexer to skip over long runs of characters.
+ * Each scanner examines [@p p, @p end) and returns @p end if it does not find what it is looking for.
+ * The @c skip_* scanners return the first character which does @em not belong to the run,
+ * the @c find_* scanners return the first match.
+ * The implementation (AVX2, SSE2 or scalar) is chosen at startup depending on the host CPU.
+ */
+const char* skip_space(const char* p, const char* end); ///< Skips @c std::isspace characters.
+const char* skip_sym(const char* p, const char* end);   ///< Skips <tt>[a-zA-Z0-9_]</tt>.
+const char* skip_dec(const char* p, const char* end);   ///< Skips <tt>[0-9_]</tt>.
+const char* find_nl(const char* p, const char* end);    ///< Finds the next <tt>'\\n'</tt>.
+const char* find_comment_end(const char* p, const char* end); ///< Finds the terminator of a block comment.
+
+enum class ISA { Scalar, SSE2, AVX2 };
+
+ISA isa();              ///< The currently used implementation.
+ISA best_isa();         ///< The best implementation supported by the host CPU.
+bool set_isa(ISA);      ///< Switches implementation; returns @c false if the host does not support it.
+const char* isa2str(ISA);
+
+}
+
+#endif
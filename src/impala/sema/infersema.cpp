@@ -1,10 +1,16 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <memory>
+#include <optional>
+#include <thread>
 
 #include "thorin/util/array.h"
 #include "thorin/util/iterator.h"
 
 #include "impala/ast.h"
 #include "impala/impala.h"
+#include "impala/trace.h"
 
 using namespace thorin;
 
@@ -87,7 +93,7 @@ public:
     const Type* rvalue(const Expr* expr) {
         auto type = infer(expr);
         if (type->isa<RefType>() || (type->isa<UnknownType>() && !expr->isa<RValueExpr>())) {
-            todo_ = true;
+            todo();
             return infer(RValueExpr::create(expr));
         }
         return type;
@@ -97,44 +103,117 @@ public:
         return ref ? ref_type(type, ref->is_mut(), ref->addr_space()) : type;
     }
 
+    /// Hides @p TypeTable::unknown_type to number the new @p UnknownType and to register it with the current context.
+    const UnknownType* unknown_type();
+
+    // worklist
+
+    /**
+     * Infers all top-level @p Item%s of @p module until nothing changes anymore.
+     * The bodies of @p FnDecl%s are inferred in isolation on up to @p num_threads threads; with a single thread, the
+     * worklist infers them, too.
+     */
+    void infer_module(const Module* module, size_t num_threads);
+
 private:
-    /// Used for union/find - see https://en.wikipedia.org/wiki/Disjoint-set_data_structure#Disjoint-set_forests .
+    static constexpr size_t no_unit = size_t(-1);
+
+    /**
+     * Used for union/find - see https://en.wikipedia.org/wiki/Disjoint-set_data_structure#Disjoint-set_forests .
+     * Nodes are stored inline in a @p Context and refer to each other by index - the GID of their @p Type minus
+     * @p TypeTable::first_gid.
+     */
     struct Representative {
-        Representative() {}
-        Representative(const Type* type)
-            : parent(this)
-            , type(type)
-        {}
+        const Type* type = nullptr; ///< @c nullptr if there is no node for this index yet.
+        size_t parent = 0;
+        int rank = 0;
+        /// Units which looked at this @p UnknownType; they must be inferred again once it is unified.
+        std::vector<size_t> dependents;
+        size_t last_dependent = no_unit;
+    };
 
-        bool is_root() const { return parent != nullptr; }
+    /**
+     * Union-find state of the thread.
+     * The main context is used by the worklist.
+     * An isolated context infers @p FnDecl bodies on a worker - one at a time - and only reads the frozen main context.
+     */
+    struct Context {
+        bool contains(size_t i) const { return i < representatives.size() && representatives[i].type != nullptr; }
+        /// Drops all nodes so the next @p FnDecl body can be inferred in this isolated context.
+        void reset() {
+            for (auto i : used)
+                representatives[i] = Representative();
+            used.clear();
+            unknowns.clear();
+            todo = false;
+        }
 
-        Representative* parent = nullptr;
-        const Type* type = nullptr;
-        int rank = 0;
+        std::vector<Representative> representatives; ///< Indexed by GID minus @p TypeTable::first_gid; grows on demand.
+        std::vector<size_t> used;                   ///< Indices of the nodes of an isolated context; see @p reset.
+        const Context* parent = nullptr;            ///< Frozen main context or @c nullptr for the main context itself.
+        std::vector<const UnknownType*> unknowns;   ///< @p UnknownType%s created by this isolated context; numbered at the join.
+        size_t unit = no_unit;                      ///< Unit currently being inferred.
+        bool todo = false;                          ///< Something outside of any unit changed.
+    };
+
+    /// Thrown when an isolated context runs into an @p UnknownType of the main context which has not been resolved yet.
+    struct Escape {};
+
+    enum class UnitState : uint8_t {
+        Serial,   ///< Inferred by the worklist.
+        Deferred, ///< Only the head is inferred by the worklist; the body awaits isolated inference.
+        Isolated, ///< Only the head is inferred by the worklist; the body has been inferred in isolation.
     };
 
-    Representative* representative(const Type* type);
-    Representative* find(Representative* repr);
+    Context& context() { return current_context_ ? *current_context_ : main_; }
+    Representative& repr(size_t i) { return context().representatives[i]; }
+    /// Returns the index of the node of @p type and creates it if necessary.
+    size_t representative(const Type* type);
+    /// Creates the node of @p type at index @p i with @p repr_type as its initial type.
+    void emplace(Context& ctx, size_t i, const Type* repr_type);
+    /// Resolves @p type - which the current isolated context did not create - in the parent context.
+    const Type* import(const Context& ctx, const Type* type);
+    size_t find(size_t i);
     const Type* find(const Type* type);
 
+    /// The current unit must be inferred again.
+    void todo();
+    /// Records that the current unit depends on all @p UnknownType%s within @p type.
+    void depend(const Type* type);
+    void depend(size_t i);
+    /// @p child is no longer a root: its dependents must be inferred again and from now on depend on @p root.
+    void notify(size_t root, size_t child);
+    void infer_unit(size_t unit);
+    /// Runs full passes and worklist rounds over the main context until nothing changes anymore.
+    void fixpoint();
+    /// Infers the body of @p unit within @p ctx until nothing changes anymore; returns @c false if it had to @p Escape.
+    bool infer_isolated(size_t unit, Context& ctx);
+    /// Infers all @p UnitState::Deferred bodies in isolation; the ones which @p Escape fall back to the worklist.
+    void infer_deferred(size_t num_threads);
+
     /**
      * @p x will be the new representative.
      * Returns again @p x.
      */
-    Representative* unify(Representative* x, Representative* y);
+    size_t unify(size_t x, size_t y);
 
     /**
      * Depending on the rank either @p x or @p y will be the new representative.
      * Returns the new representative.
      */
-    Representative* unify_by_rank(Representative* x, Representative* y);
+    size_t unify_by_rank(size_t x, size_t y);
 
-    TypeMap<std::unique_ptr<Representative>> representatives_;
-    bool todo_ = true;
+    Context main_;
+    std::vector<const Item*> units_; ///< Top-level @p Item%s; the granularity of the worklist.
+    std::vector<UnitState> states_;
+    std::vector<bool> dirty_;        ///< Units which must be inferred again.
+    size_t num_unknowns_ = 0;
 
-    friend void type_inference(std::unique_ptr<TypeTable>& typetable, const Module*);
+    static thread_local Context* current_context_;
 };
 
+thread_local InferSema::Context* InferSema::current_context_ = nullptr;
+
 //------------------------------------------------------------------------------
 
 /*
@@ -150,12 +229,11 @@ const Type* InferSema::reduce(const Lambda* lambda, ASTTypeArgs ast_type_args, s
         while (type_args.size() < num)
             type_args.push_back(unknown_type());
 
-        size_t i = type_args.size();
-        const Type* type = lambda;
-        while (auto lambda = type->isa<Lambda>())
-            type = app(lambda, type_args[--i]);
+        // resolved arguments let later passes hit the instantiation cache
+        for (auto& type_arg : type_args)
+            find_type(type_arg);
 
-        return type;
+        return instantiate(lambda, type_args);
     }
 
     return type_error();
@@ -197,13 +275,21 @@ const Type* InferSema::close(int num_lambdas, const Type* body) {
 const Type* InferSema::find_type(const Type*& type) {
     if (type == nullptr)
         return type = unknown_type();
-    return type = find(type);
+    // do not write back unchanged types: isolated contexts read the nodes of other items concurrently
+    auto result = find(type);
+    if (result != type)
+        type = result;
+    return result;
 }
 
 const Type*& InferSema::constrain(const Type*& t, const Type* u) {
     if (t == nullptr)
         return t = find(u);
-    return t = unify(t, u);
+    // see find_type
+    auto result = unify(t, u);
+    if (result != t)
+        t = result;
+    return t;
 }
 
 const Type* InferSema::coerce(const Type* dst, const Expr* src) {
@@ -232,17 +318,17 @@ const Type* InferSema::unify(const Type* dst, const Type* src) {
     auto dst_repr = find(representative(dst));
     auto src_repr = find(representative(src));
 
-    dst = dst_repr->type;
-    src = src_repr->type;
+    dst = repr(dst_repr).type;
+    src = repr(src_repr).type;
 
     // normalize singleton tuples to their element
     if (src->isa<TupleType>() && src->num_ops() == 1) src = src->op(0);
     if (dst->isa<TupleType>() && dst->num_ops() == 1) dst = dst->op(0);
 
     if (dst->isa<UnknownType>() && src->isa<UnknownType>())
-        return unify_by_rank(dst_repr, src_repr)->type;
-    if (dst->isa<UnknownType>()) return unify(src_repr, dst_repr)->type;
-    if (src->isa<UnknownType>()) return unify(dst_repr, src_repr)->type;
+        return repr(unify_by_rank(dst_repr, src_repr)).type;
+    if (dst->isa<UnknownType>()) return repr(unify(src_repr, dst_repr)).type;
+    if (src->isa<UnknownType>()) return repr(unify(dst_repr, src_repr)).type;
 
     if (dst == src && dst->is_known()) return dst;
     if (dst->isa<TypeError>() || dst->isa<InferError>()) return dst; // propagate errors
@@ -283,66 +369,342 @@ const Type* InferSema::unify(const Type* dst, const Type* src) {
  * union-find
  */
 
-auto InferSema::representative(const Type* type) -> Representative* {
-    auto i = representatives_.find(type);
-    if (i == representatives_.end()) {
-        auto p = representatives_.emplace(type, std::make_unique<Representative>(type));
-        assert_unused(p.second);
-        i = p.first;
+size_t InferSema::representative(const Type* type) {
+    auto& ctx = context();
+    auto i = type->gid() - first_gid();
+    if (!ctx.contains(i))
+        emplace(ctx, i, ctx.parent != nullptr && !type->is_known() ? import(ctx, type) : type);
+    if (type->tag() == Tag_unknown)
+        depend(i);
+    return i;
+}
+
+void InferSema::emplace(Context& ctx, size_t i, const Type* repr_type) {
+    if (i >= ctx.representatives.size())
+        ctx.representatives.resize(std::max(i + 1, Type::gid_counter() - first_gid()));
+    auto& node = ctx.representatives[i];
+    node.type = repr_type;
+    node.parent = i;
+    if (ctx.parent != nullptr)
+        ctx.used.push_back(i);
+}
+
+/*
+ * An isolated context registers the UnknownTypes it creates right away.
+ * Any other UnknownType stems from the main context: if it has been resolved there, the isolated context simply uses
+ * the resolved type. Otherwise, the body would have to change the main context and the isolated inference escapes.
+ * Thus, an isolated body only depends on types which never change again.
+ */
+const Type* InferSema::import(const Context& ctx, const Type* type) {
+    if (type->tag() == Tag_unknown) {
+        auto i = type->gid() - first_gid();
+        if (ctx.contains(i))
+            return type;
+
+        const auto& reprs = ctx.parent->representatives;
+        if (!ctx.parent->contains(i))
+            throw Escape();
+        while (reprs[i].parent != i)
+            i = reprs[i].parent;
+        if (!reprs[i].type->is_known())
+            throw Escape();
+        return reprs[i].type;
+    }
+
+    for (auto op : type->ops()) {
+        if (!op->is_known())
+            import(ctx, op);
     }
-    return &*i->second;
+    return type;
 }
 
-auto InferSema::find(Representative* repr) -> Representative* {
-    if (repr->parent != repr) {
-        todo_ = true;
-        repr->parent = find(repr->parent);
+size_t InferSema::find(size_t i) {
+    auto parent = repr(i).parent;
+    if (parent != i) {
+        todo();
+        parent = find(parent);
+        repr(i).parent = parent;
     }
-    return repr->parent;
+    return parent;
 }
 
 const Type* InferSema::find(const Type* type) {
-    return find(representative(type))->type;
+    depend(type);
+    auto root = find(representative(type));
+    return repr(root).type;
 }
 
-auto InferSema::unify(Representative* x, Representative* y) -> Representative* {
-    assert(x->is_root() && y->is_root());
+size_t InferSema::unify(size_t x, size_t y) {
+    assert(repr(x).parent == x && repr(y).parent == y);
 
     if (x == y)
         return x;
-    ++x->rank;
-    todo_ = true;
-    return y->parent = x;
+    ++repr(x).rank;
+    todo();
+    notify(x, y);
+    return repr(y).parent = x;
 }
 
-auto InferSema::unify_by_rank(Representative* x, Representative* y) -> Representative* {
-    assert(x->is_root() && y->is_root());
+size_t InferSema::unify_by_rank(size_t x, size_t y) {
+    assert(repr(x).parent == x && repr(y).parent == y);
 
     if (x == y)
         return x;
-    if (x->rank < y->rank)
-        return x->parent = y;
-    else if (x->rank > y->rank)
-        return y->parent = x;
+    if (repr(x).rank < repr(y).rank) {
+        notify(y, x);
+        return repr(x).parent = y;
+    } else if (repr(x).rank > repr(y).rank) {
+        notify(x, y);
+        return repr(y).parent = x;
+    } else {
+        ++repr(x).rank;
+        notify(x, y);
+        return repr(y).parent = x;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+/*
+ * worklist
+ */
+
+const UnknownType* InferSema::unknown_type() {
+    auto type = TypeTable::unknown_type();
+    auto& ctx = context();
+    if (ctx.parent != nullptr) {
+        emplace(ctx, type->gid() - first_gid(), type);
+        ctx.unknowns.push_back(type);
+    } else {
+        type->id_ = ++num_unknowns_;
+    }
+    return type;
+}
+
+void InferSema::todo() {
+    auto& ctx = context();
+    if (ctx.unit != no_unit)
+        dirty_[ctx.unit] = true;
+    else
+        ctx.todo = true;
+}
+
+void InferSema::depend(const Type* type) {
+    if (context().unit == no_unit || type->is_known())
+        return;
+    if (type->tag() == Tag_unknown)
+        representative(type);
     else {
-        ++x->rank;
-        return y->parent = x;
+        for (auto op : type->ops())
+            depend(op);
+    }
+}
+
+void InferSema::depend(size_t i) {
+    auto unit = context().unit;
+    auto& r = repr(i);
+    if (unit != no_unit && r.last_dependent != unit) {
+        r.dependents.push_back(unit);
+        r.last_dependent = unit;
+    }
+}
+
+void InferSema::notify(size_t root, size_t child) {
+    auto& r = repr(root);
+    auto& c = repr(child);
+    for (auto unit : c.dependents)
+        dirty_[unit] = true;
+    r.dependents.insert(r.dependents.end(), c.dependents.begin(), c.dependents.end());
+    r.last_dependent = no_unit;
+    c.dependents.clear();
+    c.dependents.shrink_to_fit();
+}
+
+void InferSema::infer_unit(size_t unit) {
+    auto item = units_[unit];
+    // a FnDecl records its own span - just like the FnDecls nested in other items
+    std::optional<Trace::Span> span;
+    if (!item->isa<FnDecl>())
+        span.emplace("infer", item->is_no_decl() ? std::string_view("<item>") : item->symbol().view(), item->loc());
+    main_.unit = unit;
+    infer_head(item);
+    if (states_[unit] == UnitState::Serial)
+        infer(item);
+    main_.unit = no_unit;
+}
+
+/*
+ * Each top-level item is a unit of work.
+ * A full pass over the module infers the heads of all items and then their bodies, just like Module::infer.
+ * Afterwards, only those units are inferred again which either changed their own AST or looked at an UnknownType which
+ * has been unified in the meantime.
+ * Once the worklist runs dry, the fixpoint is reached: each unit was inferred after the last change it depends on.
+ * Only progress which cannot be attributed to a unit - see @p todo - requires another full pass.
+ */
+void InferSema::fixpoint() {
+    auto& stats = infer_stats();
+    std::vector<size_t> worklist;
+    while (true) {
+        ++stats.passes;
+        main_.todo = false;
+        for (size_t i = 0, e = units_.size(); i != e; ++i) {
+            main_.unit = i;
+            infer_head(units_[i]);
+        }
+        main_.unit = no_unit;
+        for (size_t i = 0, e = units_.size(); i != e; ++i)
+            infer_unit(i);
+
+        while (!main_.todo) {
+            worklist.clear();
+            for (size_t i = 0, e = units_.size(); i != e; ++i) {
+                if (dirty_[i]) {
+                    worklist.push_back(i);
+                    dirty_[i] = false;
+                }
+            }
+            if (worklist.empty())
+                break;
+
+            ++stats.rounds;
+            stats.revisits += worklist.size();
+            for (auto unit : worklist)
+                infer_unit(unit);
+        }
+
+        if (!main_.todo)
+            break;
+    }
+}
+
+/*
+ * An escaped body is inferred once more by the worklist without undoing what the isolated inference did to its AST:
+ * - Nodes may keep UnknownTypes of the isolated context. The main context does not know them and just treats them like
+ *   fresh UnknownTypes - the very same thing constrain creates for a node without a type.
+ * - Any other type of a node only stems from the body itself and from types which are resolved in the main context;
+ *   the worklist derives it again.
+ * - Inserted RValueExprs and casts are exactly the ones the worklist would insert; it never inserts them twice as it
+ *   already revisits the same AST many times.
+ * test/determinism.py compares the annotated ASTs of -j1 - which only uses the worklist - and -jN on all tests.
+ */
+bool InferSema::infer_isolated(size_t unit, Context& ctx) {
+    auto prev = current_context_;
+    current_context_ = &ctx;
+    bool escaped = false;
+    try {
+        do {
+            ctx.todo = false;
+            infer(units_[unit]);
+        } while (ctx.todo);
+    } catch (Escape) {
+        escaped = true;
+    }
+    current_context_ = prev;
+    return !escaped;
+}
+
+/*
+ * Once the worklist has fixed the heads of all items, the body of a FnDecl usually only depends on types which are
+ * already known. Such bodies are inferred on worker threads - each one in its own isolated context and with its own
+ * Arena for the AST nodes inserted by inference.
+ * The main context is frozen meanwhile and all other shared state - the TypeTable and the AST nodes of other items - is
+ * only read or hash-consed concurrently.
+ * Afterwards, the UnknownTypes of the isolated contexts are numbered in unit order. Together with the fact that an
+ * isolated body never depends on anything but its own AST and known types, the result does not depend on the number
+ * of threads.
+ */
+void InferSema::infer_deferred(size_t num_threads) {
+    struct Job {
+        size_t unit;
+        std::unique_ptr<Arena> arena = std::make_unique<Arena>();
+        std::vector<const UnknownType*> unknowns;
+        std::exception_ptr exception;
+        bool escaped = false;
+    };
+
+    std::vector<Job> jobs;
+    for (size_t i = 0, e = units_.size(); i != e; ++i) {
+        if (states_[i] == UnitState::Deferred) {
+            jobs.emplace_back();
+            jobs.back().unit = i;
+        }
+    }
+
+    std::atomic<size_t> next = 0;
+    auto work = [&] {
+        // each worker reuses its isolated context for all of its jobs
+        Context context;
+        context.parent = &main_;
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < jobs.size();) {
+            auto& job = jobs[i];
+            Arena::Scope arena_scope(*job.arena);
+            try {
+                job.escaped = !infer_isolated(job.unit, context);
+            } catch (...) {
+                job.exception = std::current_exception();
+            }
+            job.unknowns.swap(context.unknowns);
+            context.reset();
+        }
+    };
+
+    num_threads = std::min(num_threads, jobs.size());
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < num_threads; ++t)
+        threads.emplace_back(work);
+    work();
+    for (auto& thread : threads)
+        thread.join();
+
+    auto& stats = infer_stats();
+    for (auto& job : jobs) {
+        if (job.exception)
+            std::rethrow_exception(job.exception);
+        for (auto unknown : job.unknowns)
+            unknown->id_ = ++num_unknowns_;
+        if (job.escaped) {
+            states_[job.unit] = UnitState::Serial;
+            ++stats.escaped;
+        } else {
+            states_[job.unit] = UnitState::Isolated;
+            ++stats.isolated;
+        }
+        // see parse
+        Arena::adopt(std::move(*job.arena));
+    }
+}
+
+void InferSema::infer_module(const Module* module, size_t num_threads) {
+    auto& stats = infer_stats();
+    stats = InferStats();
+
+    for (auto&& item : module->items()) {
+        auto fn_decl = item->isa<FnDecl>();
+        units_.push_back(item.get());
+        states_.push_back(num_threads > 1 && fn_decl && fn_decl->body() ? UnitState::Deferred : UnitState::Serial);
+    }
+    dirty_.assign(units_.size(), false);
+    stats.units = units_.size();
+
+    fixpoint();
+    if (std::find(states_.begin(), states_.end(), UnitState::Deferred) != states_.end()) {
+        infer_deferred(num_threads);
+        if (stats.escaped != 0)
+            fixpoint();
     }
 }
 
 //------------------------------------------------------------------------------
 
-void type_inference(std::unique_ptr<TypeTable>& typetable, const Module* module) {
+void type_inference(std::unique_ptr<TypeTable>& typetable, const Module* module, size_t num_threads) {
     auto sema = new InferSema;
     typetable.reset(sema);
+    sema->infer_module(module, num_threads);
+}
 
-    int i = 0;
-    for (;sema->todo_; ++i) {
-        sema->todo_ = false;
-        sema->infer(module);
-    }
-
-    //DLOG("iterations needed for type inference: {}", i);
+InferStats& infer_stats() {
+    static InferStats stats;
+    return stats;
 }
 
 //------------------------------------------------------------------------------
@@ -380,13 +742,16 @@ const Type* Path::infer(InferSema& sema) const {
         auto cur_type = sema.find_type(cur_elem);
 
         if (auto enum_type = last_type->isa<EnumType>()) {
-            // lookup enum option
+            // lookup enum option - by name only the first time
             auto enum_decl = enum_type->enum_decl();
-            auto option_decl = enum_decl->option_decl(cur_elem->symbol());
-            auto option_type = option_decl ? sema.find_type(*option_decl) : sema.type_error();
+            auto option_decl = cur_elem->decl_ ? cur_elem->decl_->isa<OptionDecl>() : nullptr;
+            if (option_decl == nullptr || option_decl->enum_decl() != enum_decl)
+                option_decl = enum_decl->option_decl(cur_elem->symbol()).value_or(nullptr);
+            auto option_type = option_decl ? sema.find_type(option_decl) : sema.type_error();
 
             cur_type = sema.constrain(cur_elem, sema.find_type(option_type));
-            cur_elem->decl_ = option_decl.value_or(nullptr);
+            if (cur_elem->decl_ != option_decl)
+                cur_elem->decl_ = option_decl;
         } else if (last_type->is_known()) {
             cur_type = sema.constrain(cur_elem, sema.type_error());
         }
@@ -570,6 +935,7 @@ void StructDecl::infer(InferSema& sema) const {
 const Type* FieldDecl::infer(InferSema& sema) const { return sema.infer(ast_type()); }
 
 void FnDecl::infer(InferSema& sema) const {
+    Trace::Span span("infer", symbol().view(), loc());
     infer_ast_type_params(sema);
 
     sema.infer(filter());
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <vector>
+
 #include "impala/ast.h"
 #include "impala/impala.h"
 
@@ -5,6 +8,11 @@ namespace impala {
 
 //------------------------------------------------------------------------------
 
+/**
+ * Resolves names with one slot per @p Symbol - indexed by @p Symbol::id - holding its current binding.
+ * Each @p Decl saves the binding it shadows when it enters its scope; leaving the scope restores these bindings.
+ * Thus, a lookup is a plain array load.
+ */
 class NameSema {
 public:
     /**
@@ -41,8 +49,9 @@ public:
 
 private:
     size_t depth() const { return levels_.size(); }
+    const Decl* slot(Symbol symbol) const { return symbol.id() < slots_.size() ? slots_[symbol.id()] : nullptr; }
 
-    thorin::HashMap<Symbol, const Decl*, Symbol::Hash> symbol2decl_;
+    std::vector<const Decl*> slots_; ///< Current binding of each @p Symbol; grows on demand.
     std::vector<const Decl*> decl_stack_;
     std::vector<size_t> levels_;
 
@@ -56,10 +65,10 @@ const Decl* NameSema::lookup(const ASTNode* n, Symbol symbol) {
     assert(!symbol.empty() && "symbol is empty");
 
     if (!symbol.is_anonymous()) {
-        auto decl = symbol2decl_.lookup(symbol);
-        if (!decl)
+        auto decl = slot(symbol);
+        if (decl == nullptr)
             error(n, "'{}' not found in current scope", symbol);
-        return *decl;
+        return decl;
     } else {
         error(n, "identifier '_' is reserved for anonymous declarations");
         return nullptr;
@@ -79,26 +88,26 @@ void NameSema::insert(const Decl* decl) {
 
         assert(clash(symbol) == nullptr && "must not be found");
 
-        auto i = symbol2decl_.find(symbol);
-        decl->shadows_ = i != symbol2decl_.end() ? i->second : nullptr;
+        if (symbol.id() >= slots_.size())
+            slots_.resize(std::max(size_t(symbol.id()) + 1, Symbol::num_symbols()), nullptr);
+        decl->shadows_ = slots_[symbol.id()];
         decl->depth_ = depth();
         decl_stack_.push_back(decl);
-        symbol2decl_[symbol] = decl;
+        slots_[symbol.id()] = decl;
     }
 }
 
 const Decl* NameSema::clash(Symbol symbol) const {
     assert(!symbol.empty() && "symbol is empty");
-    if (auto decl = symbol2decl_.lookup(symbol))
-        return (*decl && (*decl)->depth() == depth()) ? *decl : nullptr;
-    return nullptr;
+    auto decl = slot(symbol);
+    return decl != nullptr && decl->depth() == depth() ? decl : nullptr;
 }
 
 void NameSema::pop_scope() {
     size_t level = levels_.back();
     for (size_t i = level, e = decl_stack_.size(); i != e; ++i) {
         const Decl* decl = decl_stack_[i];
-        symbol2decl_[decl->symbol()] = decl->shadows();
+        slots_[decl->symbol().id()] = decl->shadows();
     }
 
     decl_stack_.resize(level);
@@ -59,10 +59,8 @@ const Type* FnType::return_type() const {
     return table().type_noret();
 }
 
-bool is_subtype(const Type* dst, const Type* src) {
-    if (dst == src)
-        return true;
-
+/// The actual structural check behind @p is_subtype; recursive queries go through the memo again.
+static bool check_subtype(const Type* dst, const Type* src) {
     if (dst->isa<StructType>() || dst->isa<EnumType>())
         // structs and enums are the only nominal types
         return false;
@@ -113,6 +111,12 @@ bool is_subtype(const Type* dst, const Type* src) {
     return false;
 }
 
+bool is_subtype(const Type* dst, const Type* src) {
+    if (dst == src)
+        return true;
+    return dst->table().is_subtype(dst, src);
+}
+
 bool is_strict_subtype(const Type* dst, const Type* src) {
     return dst != src && is_subtype(dst, src);
 }
@@ -123,14 +127,18 @@ bool is_strict_subtype(const Type* dst, const Type* src) {
  * hash
  */
 
-uint32_t RefTypeBase::vhash() const {
-    return thorin::hash_combine(Type::vhash(), ((uint32_t)addr_space() << uint32_t(1)) | uint32_t(is_mut()));
+uint32_t RefTypeBase::hash_of(int tag, const Type* pointee, bool mut, uint64_t addr_space) {
+    return thorin::hash_combine(Type::hash_of(tag, {pointee}), ((uint32_t)addr_space << uint32_t(1)) | uint32_t(mut));
 }
 
-uint32_t Var::vhash() const {
-    return thorin::murmur3(uint32_t(tag()) << uint32_t(24) | uint32_t(depth()));
+uint32_t RefTypeBase::vhash() const { return hash_of(tag(), pointee(), is_mut(), addr_space()); }
+
+uint32_t Var::hash_of(int depth) {
+    return thorin::murmur3(uint32_t(Tag_var) << uint32_t(24) | uint32_t(depth));
 }
 
+uint32_t Var::vhash() const { return hash_of(depth()); }
+
 //------------------------------------------------------------------------------
 
 /*
@@ -156,7 +164,7 @@ bool UnknownType::equal(const Type* other) const { return this == other; }
  */
 
 Stream& Lambda::stream(Stream& os) const { return os.fmt("[{}].{}", name(), body()); }
-Stream& UnknownType::stream(Stream& os) const { return os << '?' << gid(); }
+Stream& UnknownType::stream(Stream& os) const { return os << '?' << id(); }
 
 Stream& PrimType::stream(Stream& os) const {
     switch (primtype_tag()) {
@@ -263,16 +271,18 @@ const Type* EnumType::vreduce(int depth, const Type* type, Type2Type& map) const
 //------------------------------------------------------------------------------
 
 TypeTable::TypeTable()
-    : unit_(unify(new TupleType(*this, {})))
-    , type_noret_(unify(new NoRetType(*this)))
-    , type_error_(unify(new TypeError(*this)))
-#define IMPALA_TYPE(itype, atype) , itype##_(unify(new PrimType(*this, PrimType_##itype)))
+    : unit_(unify_ops<TupleType>(Tag_tuple, Types(), Types()))
+    , type_noret_(unify_ops<NoRetType>(Tag_noret, Types()))
+    , type_error_(unify_ops<TypeError>(Tag_error, Types()))
+#define IMPALA_TYPE(itype, atype) , itype##_(unify_ops<PrimType>(Tag_##itype, Types(), PrimType_##itype))
 #include "impala/tokenlist.h"
 {}
 
 const Type* TypeTable::app(const Type* callee, const Type* op) {
-    auto app = unify(new App(*this, callee, op));
+    auto app = unify_ops<App>(Tag_app, {callee, op}, callee, op);
 
+    // reducing a polymorphic struct/enum creates fresh nominal types - only one thread may fill the cache
+    std::lock_guard<std::recursive_mutex> lock(app_mutex_);
     if (auto cache = app->cache_)
         return cache;
     if (auto lambda = app->callee()->isa<Lambda>()) {
@@ -285,17 +295,56 @@ const Type* TypeTable::app(const Type* callee, const Type* op) {
     return app;
 }
 
+/*
+ * A generic function with n type parameters is a chain of n Lambdas. Applying them one by one reduces each
+ * intermediate body again although the whole chain only depends on the lambda and the type arguments.
+ * Only fully known type arguments are cached: an UnknownType is unique to its call site and would merely fill the
+ * cache with entries which are never hit again.
+ * Like is_subtype, the reduction runs without holding the lock; app guards App::cache_ on its own.
+ */
+const Type* TypeTable::instantiate(const Lambda* lambda, Types type_args) {
+    auto args = type_args.size() == 1 ? type_args.front() : tuple_type(type_args);
+
+    bool known = args->is_known();
+    {
+        std::lock_guard<std::recursive_mutex> lock(app_mutex_);
+        ++instantiation_stats_.queries;
+        if (known) {
+            if (auto result = instantiations_.lookup({lambda, args})) {
+                ++instantiation_stats_.hits;
+                return *result;
+            }
+        }
+    }
+
+    size_t i = type_args.size();
+    const Type* type = lambda;
+    while (auto inner = type->isa<Lambda>())
+        type = app(inner, type_args[--i]);
+    if (!known)
+        return type;
+
+    std::lock_guard<std::recursive_mutex> lock(app_mutex_);
+    // another thread may have been faster - keep its result so all uses agree on the nominal types it created
+    if (auto result = instantiations_.lookup({lambda, args}))
+        return *result;
+    return instantiations_[{lambda, args}] = type;
+}
+
+TypeTable::InstantiationStats TypeTable::instantiation_stats() const {
+    std::lock_guard<std::recursive_mutex> lock(app_mutex_);
+    return instantiation_stats_;
+}
+
 const StructType* TypeTable::struct_type(const StructDecl* decl, size_t size) {
-    auto type = new StructType(*this, decl, size);
-    const auto& p = types_.insert(type);
-    assert_unused(p.second && "hash/equal broken");
+    auto type = make<StructType>(*this, decl, size);
+    insert(type);
     return type;
 }
 
 const EnumType* TypeTable::enum_type(const EnumDecl* decl, size_t size) {
-    auto type = new EnumType(*this, decl, size);
-    const auto& p = types_.insert(type);
-    assert_unused(p.second && "hash/equal broken");
+    auto type = make<EnumType>(*this, decl, size);
+    insert(type);
     return type;
 }
 
@@ -307,6 +356,33 @@ const PrimType* TypeTable::prim_type(const PrimTypeTag tag) {
     }
 }
 
+/*
+ * Types are hash-consed and never change - apart from the operands of nominal types which never are subtypes of
+ * anything but themselves. Thus, a (dst, src) pair determines the answer once and for all.
+ * The lock is not held during the check itself, as it recurses into is_subtype; two threads may check the same pair
+ * at the same time and record the same answer.
+ */
+bool TypeTable::is_subtype(const Type* dst, const Type* src) {
+    {
+        std::lock_guard<std::mutex> lock(subtype_mutex_);
+        ++subtype_stats_.queries;
+        if (auto result = subtypes_.lookup({dst, src})) {
+            ++subtype_stats_.hits;
+            return *result;
+        }
+    }
+
+    bool result = check_subtype(dst, src);
+    std::lock_guard<std::mutex> lock(subtype_mutex_);
+    subtypes_[{dst, src}] = result;
+    return result;
+}
+
+TypeTable::SubtypeStats TypeTable::subtype_stats() const {
+    std::lock_guard<std::mutex> lock(subtype_mutex_);
+    return subtype_stats_;
+}
+
 const InferError* TypeTable::infer_error(const Type* dst, const Type* src) {
     if (auto di = dst->isa<InferError>()) {
         if (di->src() == src)
@@ -318,7 +394,7 @@ const InferError* TypeTable::infer_error(const Type* dst, const Type* src) {
             return si;
     }
 
-    return unify(new InferError(*this, dst, src));
+    return unify_ops<InferError>(Tag_infer_error, {dst, src}, dst, src);
 }
 
 //------------------------------------------------------------------------------
@@ -1,6 +1,10 @@
 #ifndef IMPALA_SEMA_TYPE_H
 #define IMPALA_SEMA_TYPE_H
 
+#include <mutex>
+#include <new>
+#include <utility>
+
 #include "thorin/def.h"
 #include "thorin/util/array.h"
 #include "thorin/util/cast.h"
@@ -114,6 +118,8 @@ public:
     bool equal(const Type* other) const override;
     virtual std::string prefix() const = 0;
 
+    static uint32_t hash_of(int tag, const Type* pointee, bool mut, uint64_t addr_space);
+
 private:
     bool mut_;
     uint64_t addr_space_;
@@ -269,6 +275,8 @@ public:
     int depth() const { return depth_; }
     Stream& stream(Stream&) const override;
 
+    static uint32_t hash_of(int depth);
+
 private:
     uint32_t vhash() const override;
     bool equal(const Type*) const override;
@@ -319,7 +327,7 @@ public:
 class StructType : public Type {
 private:
     StructType(TypeTable& table, const StructDecl* decl, size_t size)
-        : Type(table, Tag_struct, thorin::Array<const Type*>(size))
+        : Type(table, Tag_struct, size)
         , decl_(decl)
     {
         nominal_ = true;
@@ -344,7 +352,7 @@ private:
 class EnumType : public Type {
 private:
     EnumType(TypeTable& table, const EnumDecl* decl, size_t size)
-        : Type(table, Tag_enum, thorin::Array<const Type*>(size))
+        : Type(table, Tag_enum, size)
         , decl_(decl)
     {
         nominal_ = true;
@@ -399,11 +407,15 @@ public:
     {}
 
     uint64_t dim() const { return dim_; }
-    uint32_t vhash() const override { return thorin::hash_combine(Type::vhash(), dim()); }
+    uint32_t vhash() const override { return hash_of(elem_type(), dim()); }
     bool equal(const Type* other) const override {
         return Type::equal(other) && this->dim() == other->as<DefiniteArrayType>()->dim();
     }
 
+    static uint32_t hash_of(const Type* elem_type, uint64_t dim) {
+        return thorin::hash_combine(Type::hash_of(Tag_definite_array, {elem_type}), dim);
+    }
+
     Stream& stream(Stream&) const override;
 
     virtual const Type* tangent_vector() const override;
@@ -424,11 +436,15 @@ public:
     {}
 
     uint64_t dim() const { return dim_; }
-    uint32_t vhash() const override { return thorin::hash_combine(Type::vhash(), dim()); }
+    uint32_t vhash() const override { return hash_of(elem_type(), dim()); }
     bool equal(const Type* other) const override {
         return Type::equal(other) && this->dim() == other->as<SimdType>()->dim();
     }
 
+    static uint32_t hash_of(const Type* elem_type, uint64_t dim) {
+        return thorin::hash_combine(Type::hash_of(Tag_simd, {elem_type}), dim);
+    }
+
     Stream& stream(Stream&) const override;
 
 private:
@@ -463,6 +479,8 @@ private:
     }
 
 public:
+    /// Number used when printing this @p UnknownType; unlike the GID it does not depend on the thread schedule.
+    size_t id() const { return id_; }
     Stream& stream(Stream&) const override;
 
 private:
@@ -470,7 +488,10 @@ private:
     uint32_t vhash() const override { return this->gid(); }
     const Type* vrebuild(TypeTable&, Types) const override;
 
+    mutable size_t id_ = 0;
+
     friend class TypeTable;
+    friend class InferSema;
 };
 
 class TypeError : public Type {
@@ -518,11 +539,21 @@ class TypeTable : public thorin::TypeTableBase<Type> {
 public:
     TypeTable();
 
-    const Var* var(int depth) { return unify(new Var(*this, depth)); }
+    const Var* var(int depth) {
+        return unify<Var>(Tag_var, {}, Var::hash_of(depth),
+                          [&] (const Var* var) { return var->depth() == depth; },
+                          [&] { return make<Var>(*this, depth); });
+    }
     const Type* app(const Type* callee, const Type* op);
-    const Lambda* lambda(const Type* body, const char* name) { return unify(new Lambda(*this, body, name)); }
-
-    const TupleType* tuple_type(Types ops) { assert(ops.size() != 1); return unify(new TupleType(*this, ops)); }
+    /**
+     * Applies the polymorphic @p lambda to @p type_args - one for each nested @p Lambda, the last one for the outermost.
+     * The result is cached per (@p lambda, @p type_args) if all @p type_args are known so further uses of a generic
+     * function skip the reduction.
+     */
+    const Type* instantiate(const Lambda* lambda, Types type_args);
+    const Lambda* lambda(const Type* body, const char* name) { return unify_ops<Lambda>(Tag_lambda, {body}, body, name); }
+
+    const TupleType* tuple_type(Types ops) { assert(ops.size() != 1); return unify_ops<TupleType>(Tag_tuple, ops, ops); }
     const TupleType* unit() { return unit_; }
 
     const StructType* struct_type(const StructDecl* decl, size_t size);
@@ -531,30 +562,86 @@ public:
 #define IMPALA_TYPE(itype, atype) const PrimType* type_##itype() { return itype##_; }
 #include "impala/tokenlist.h"
     const DefiniteArrayType* definite_array_type(const Type* elem_type, uint64_t dim) {
-        return unify(new DefiniteArrayType(*this, elem_type, dim));
+        return unify<DefiniteArrayType>(Tag_definite_array, {elem_type}, DefiniteArrayType::hash_of(elem_type, dim),
+                                        [&] (const DefiniteArrayType* type) { return type->dim() == dim; },
+                                        [&] { return make<DefiniteArrayType>(*this, elem_type, dim); });
     }
-    const FnType* fn_type(const Type* op) { return unify(new FnType(*this, op)); }
-    const FnType* fn_type(Types params) { return unify(new FnType(*this, params.size() == 1 ? params.front() : tuple_type(params))); }
+    const FnType* fn_type(const Type* op) { return unify_ops<FnType>(Tag_fn, {op}, op); }
+    const FnType* fn_type(Types params) { return fn_type(params.size() == 1 ? params.front() : tuple_type(params)); }
     const IndefiniteArrayType* indefinite_array_type(const Type* elem_type) {
-        return unify(new IndefiniteArrayType(*this, elem_type));
+        return unify_ops<IndefiniteArrayType>(Tag_indefinite_array, {elem_type}, elem_type);
+    }
+    const SimdType* simd_type(const Type* elem_type, uint64_t size) {
+        return unify<SimdType>(Tag_simd, {elem_type}, SimdType::hash_of(elem_type, size),
+                               [&] (const SimdType* type) { return type->dim() == size; },
+                               [&] { return make<SimdType>(*this, elem_type, size); });
     }
-    const SimdType* simd_type(const Type* elem_type, uint64_t size) { return unify(new SimdType(*this, elem_type, size)); }
     const BorrowedPtrType* borrowed_ptr_type(const Type* pointee, bool mut, uint64_t addr_space) {
-        return unify(new BorrowedPtrType(*this, pointee, mut, addr_space));
+        return unify_ref<BorrowedPtrType>(Tag_borrowed_ptr, pointee, mut, addr_space, pointee, mut, addr_space);
     }
     const OwnedPtrType* owned_ptr_type(const Type* pointee, uint64_t addr_space) {
-        return unify(new OwnedPtrType(*this, pointee, addr_space));
+        return unify_ref<OwnedPtrType>(Tag_owned_ptr, pointee, true, addr_space, pointee, addr_space);
     }
     const RefType* ref_type(const Type* pointee, bool mut, uint64_t addr_space) {
-        return unify(new RefType(*this, pointee, mut, addr_space));
+        return unify_ref<RefType>(Tag_ref, pointee, mut, addr_space, pointee, mut, addr_space);
     }
     const NoRetType* type_noret() { return type_noret_; }
     const PrimType* prim_type(PrimTypeTag tag);
-    const UnknownType* unknown_type() { return unify(new UnknownType(*this)); }
+    const UnknownType* unknown_type() { return insert(make<UnknownType>(*this))->as<UnknownType>(); }
     const TypeError* type_error() { return type_error_; }
     const InferError* infer_error(const Type* dst, const Type* src);
 
+    struct SubtypeStats {
+        size_t queries = 0; ///< Calls of @p is_subtype with different @p Type%s.
+        size_t hits    = 0; ///< Queries answered by the memo.
+    };
+
+    /// Memoized structural subtyping; use the free @p impala::is_subtype which handles <tt>dst == src</tt> first.
+    bool is_subtype(const Type* dst, const Type* src);
+    SubtypeStats subtype_stats() const;
+
+    struct InstantiationStats {
+        size_t queries = 0; ///< Calls of @p instantiate.
+        size_t hits    = 0; ///< Calls answered by the cache.
+    };
+
+    InstantiationStats instantiation_stats() const;
+
 private:
+    /// Creates a @p T in the memory of this table.
+    template<class T, class... Args>
+    const T* make(Args&&... args) { return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...); }
+
+    /// Hash-conses a @p T which is only determined by @p tag and @p ops; @p args are passed to its constructor.
+    template<class T, class... Args>
+    const T* unify_ops(int tag, Types ops, Args&&... args) {
+        return unify<T>(tag, ops, Type::hash_of(tag, ops), [] (const T*) { return true; },
+                        [&] { return make<T>(*this, std::forward<Args>(args)...); });
+    }
+
+    /// Hash-conses a @p T derived from @p RefTypeBase; @p args are passed to its constructor.
+    template<class T, class... Args>
+    const T* unify_ref(int tag, const Type* pointee, bool mut, uint64_t addr_space, Args&&... args) {
+        return unify<T>(tag, {pointee}, RefTypeBase::hash_of(tag, pointee, mut, addr_space),
+                        [&] (const T* type) { return type->is_mut() == mut && type->addr_space() == addr_space; },
+                        [&] { return make<T>(*this, std::forward<Args>(args)...); });
+    }
+
+    struct TypePairHash {
+        static uint32_t hash(std::pair<const Type*, const Type*> p) {
+            return thorin::hash_combine(thorin::hash_begin(uint32_t(p.first->gid())), uint32_t(p.second->gid()));
+        }
+        static bool eq(std::pair<const Type*, const Type*> p1, std::pair<const Type*, const Type*> p2) { return p1 == p2; }
+        static std::pair<const Type*, const Type*> sentinel() { return {(const Type*)(1), (const Type*)(1)}; }
+    };
+
+    mutable std::recursive_mutex app_mutex_; ///< Guards @p App::cache_ and @p instantiations_; @p app reduces under it and may apply nested @p App%s.
+    /// Maps a @p Lambda and its type arguments - a single one or a @p TupleType of them - to its instantiation.
+    thorin::HashMap<std::pair<const Type*, const Type*>, const Type*, TypePairHash> instantiations_;
+    InstantiationStats instantiation_stats_;
+    mutable std::mutex subtype_mutex_;
+    thorin::HashMap<std::pair<const Type*, const Type*>, bool, TypePairHash> subtypes_;
+    SubtypeStats subtype_stats_;
     const TupleType* unit_;
     const NoRetType* type_noret_;
     const TypeError* type_error_;
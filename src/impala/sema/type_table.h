@@ -3,7 +3,11 @@
 #ifndef THORIN_UTIL_TYPE_TABLE_H
 #define THORIN_UTIL_TYPE_TABLE_H
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <type_traits>
+#include <vector>
 
 #include "thorin/def.h"
 #include "thorin/util/hash.h"
@@ -11,6 +15,8 @@
 #include "thorin/util/array.h"
 #include "thorin/util/stream.h"
 
+#include "impala/arena.h"
+
 namespace thorin {
 
 #define THORIN_S_TYPES(m) m(s8)  m(s16) m(s32) m(s64)
@@ -100,6 +106,8 @@ protected:
     TypeBase& operator=(const TypeBase&) = delete;
 
     TypeBase(TypeTable& table, int tag, Types ops);
+    /// For nominal types whose @p num_ops operands are @p set later on.
+    TypeBase(TypeTable& table, int tag, size_t num_ops);
 
     void set(size_t i, const TypeBase* type) {
         ops_[i] = type;
@@ -115,10 +123,10 @@ public:
     int tag() const { return tag_; }
     TypeTable& table() const { return *table_; }
 
-    Types ops() const { return ops_; }
-    const TypeBase* op(size_t i) const { return ops()[i]; }
-    size_t num_ops() const { return ops_.size(); }
-    bool empty() const { return ops_.empty(); }
+    Types ops() const { return Types(ops_, num_ops_); }
+    const TypeBase* op(size_t i) const { return ops_[i]; }
+    size_t num_ops() const { return num_ops_; }
+    bool empty() const { return num_ops_ == 0; }
 
     bool is_nominal() const { return nominal_; }              ///< A nominal @p Type is always different from each other @p Type.
     bool is_known()   const { return known_; }                ///< Does this @p Type depend on any @p UnknownType%s?
@@ -129,6 +137,9 @@ public:
     uint32_t hash() const { return hash_ == 0 ? hash_ = vhash() : hash_; }
     virtual bool equal(const TypeBase*) const;
 
+    /// Hash of a structural @p TypeBase with @p tag and @p ops; subclasses with further fields combine them with it.
+    static uint32_t hash_of(int tag, Types ops);
+
     const TypeBase* reduce(int, const TypeBase*, Type2Type&) const;
     const TypeBase* rebuild(TypeTable& to, Types ops) const;
     const TypeBase* rebuild(Types ops) const { return rebuild(table(), ops); }
@@ -137,7 +148,7 @@ public:
     /// nullptr if the type cannot be derived.
     virtual const TypeBase* tangent_vector() const { return nullptr; }
 
-    static size_t gid_counter() { return gid_counter_; }
+    static size_t gid_counter() { return gid_counter_.load(std::memory_order_relaxed); }
     virtual Stream& stream(Stream&) const = 0;
 
 protected:
@@ -153,56 +164,137 @@ protected:
 private:
     virtual const TypeBase* vrebuild(TypeTable& to, Types ops) const = 0;
 
+    static constexpr size_t num_inline_ops = 2;
+
     mutable TypeTable* table_;
     int tag_;
-    thorin::Array<const TypeBase*> ops_;
+    size_t num_ops_;
+    const TypeBase** ops_;                          ///< Points to @p inline_ops_ or to memory of the @p table_.
+    const TypeBase* inline_ops_[num_inline_ops];
     mutable size_t gid_;
-    static size_t gid_counter_;
+    static std::atomic<size_t> gid_counter_;
 
     friend TypeTable;
 };
 
 //------------------------------------------------------------------------------
 
-/// Base class for all \p TypeTable%s.
+/**
+ * Base class for all \p TypeTable%s.
+ * Hash-consing is thread-safe: the table is split into @c num_shards shards selected by the top bits of a @p Type's
+ * hash, each guarded by its own mutex.
+ * A structural @p Type is looked up by its tag, operands and further fields before it is created; thus, a @p Type is
+ * only allocated on a miss. All @p Type%s and their operands - unless few enough to be stored inline - live in an
+ * @p impala::Arena owned by the table.
+ */
 template <class Type>
 class TypeTableBase {
 public:
-    struct TypeHash {
-        static uint32_t hash(const Type* t) { return t->hash(); }
-        static bool eq(const Type* t1, const Type* t2) { return t2->equal(t1); }
-        static const Type* sentinel() { return (const Type*)(1); }
-    };
+    using Types = ArrayRef<const Type*>;
 
-    typedef thorin::HashSet<const Type*, TypeHash> TypeSet;
+    static constexpr int shard_bits = 4;
+    static constexpr size_t num_shards = 1 << shard_bits;
 
     TypeTableBase& operator=(const TypeTableBase&) = delete;
     TypeTableBase(const TypeTableBase&) = delete;
 
-    TypeTableBase() {}
-    virtual ~TypeTableBase() { for (auto type : types_) delete type; }
+    TypeTableBase()
+        : first_gid_(Type::gid_counter())
+    {}
+    virtual ~TypeTableBase() {
+        for (auto& shard : shards_) {
+            for (auto type : shard.slots) {
+                if (type != nullptr)
+                    type->~Type();
+            }
+        }
+    }
 
-    const TypeSet& types() const { return types_; }
+    size_t num_types() const;
+    size_t num_hits() const;   ///< Lookups which found an existing @p Type and, hence, did not allocate.
+    size_t num_misses() const; ///< Lookups which created a new @p Type.
+    /// All @p Type%s of this table have a GID of at least @c first_gid(); side tables indexed by GID start here.
+    size_t first_gid() const { return first_gid_; }
 
 protected:
-    const Type* unify_base(const Type* type);
-    template<class T> const T* unify(const T* type) { return unify_base(type)->template as<T>(); }
+    /// Bump-allocates memory which lives as long as this table; thread-safe.
+    void* allocate(size_t size, size_t align) {
+        std::lock_guard<std::mutex> lock(arena_mutex_);
+        return arena_.allocate(size, align);
+    }
+
+    /**
+     * Returns the structural @p T with @p tag, @p ops and @p hash.
+     * @p eq compares the further fields of a candidate which already matches @p tag and @p ops.
+     * Only if there is no such @p T, @p make creates one.
+     */
+    template<class T, class Eq, class Make>
+    const T* unify(int tag, Types ops, uint32_t hash, Eq eq, Make make);
+
+    /// Inserts a @p Type which is always different from all others - a nominal or an unknown one.
     const Type* insert(const Type*);
 
-    TypeSet types_;
+private:
+    struct Shard {
+        template<class Eq>
+        const Type* find(uint32_t hash, Eq eq) const {
+            if (slots.empty())
+                return nullptr;
+            for (size_t i = hash & (slots.size() - 1);; i = (i + 1) & (slots.size() - 1)) {
+                auto type = slots[i];
+                if (type == nullptr)
+                    return nullptr;
+                if (type->hash() == hash && eq(type))
+                    return type;
+            }
+        }
+
+        void insert(const Type* type) {
+            if (2 * (size + 1) > slots.size())
+                rehash(slots.empty() ? 64 : 2 * slots.size());
+            size_t i = type->hash() & (slots.size() - 1);
+            while (slots[i] != nullptr)
+                i = (i + 1) & (slots.size() - 1);
+            slots[i] = type;
+            ++size;
+        }
+
+        void rehash(size_t capacity) {
+            std::vector<const Type*> old(capacity, nullptr);
+            old.swap(slots);
+            size = 0;
+            for (auto type : old) {
+                if (type != nullptr)
+                    insert(type);
+            }
+        }
+
+        mutable std::mutex mutex;
+        std::vector<const Type*> slots;
+        size_t size = 0;
+        size_t num_hits = 0;
+        size_t num_misses = 0;
+    };
+
+    /// Fibonacci hashing spreads small hashes like those of unknown types, which are just their GIDs.
+    Shard& shard(uint32_t hash) { return shards_[(hash * 2654435769u) >> (32 - shard_bits)]; }
+
+    size_t first_gid_;
+    Shard shards_[num_shards];
+    std::mutex arena_mutex_;
+    impala::Arena arena_;
+
+    friend Type;
 };
 
 //------------------------------------------------------------------------------
 
 template <class TypeTable>
-size_t TypeBase<TypeTable>::gid_counter_ = 1;
+std::atomic<size_t> TypeBase<TypeTable>::gid_counter_ = 1;
 
 template <class TypeTable>
 TypeBase<TypeTable>::TypeBase(TypeTable& table, int tag, Types ops)
-    : table_(&table)
-    , tag_(tag)
-    , ops_(ops.size())
-    , gid_(gid_counter_++)
+    : TypeBase(table, tag, ops.size())
 {
     for (size_t i = 0, e = num_ops(); i != e; ++i) {
         if (auto op = ops[i])
@@ -210,6 +302,19 @@ TypeBase<TypeTable>::TypeBase(TypeTable& table, int tag, Types ops)
     }
 }
 
+template <class TypeTable>
+TypeBase<TypeTable>::TypeBase(TypeTable& table, int tag, size_t num_ops)
+    : table_(&table)
+    , tag_(tag)
+    , num_ops_(num_ops)
+    , ops_(num_ops <= num_inline_ops
+           ? inline_ops_
+           : static_cast<const TypeBase**>(table.allocate(num_ops * sizeof(const TypeBase*), alignof(const TypeBase*))))
+    , gid_(gid_counter_.fetch_add(1, std::memory_order_relaxed))
+{
+    std::fill_n(ops_, num_ops_, nullptr);
+}
+
 template <class TypeTable>
 const TypeBase<TypeTable>* TypeBase<TypeTable>::reduce(int depth, const TypeBase* type, Type2Type& map) const {
     if (auto result = map.lookup(this))
@@ -239,15 +344,19 @@ const TypeBase<TypeTable>* TypeBase<TypeTable>::rebuild(TypeTable& to, Types ops
     return vrebuild(to, ops);
 }
 
+template <class TypeTable>
+uint32_t TypeBase<TypeTable>::hash_of(int tag, Types ops) {
+    uint32_t seed = thorin::hash_begin(uint8_t(tag));
+    for (auto op : ops)
+        seed = thorin::hash_combine(seed, uint32_t(op->gid()));
+    return seed;
+}
+
 template <class TypeTable>
 uint32_t TypeBase<TypeTable>::vhash() const {
     if (is_nominal())
         return thorin::murmur3(uint32_t(gid()));
-
-    uint32_t seed = thorin::hash_begin(uint8_t(tag()));
-    for (auto op : ops_)
-        seed = thorin::hash_combine(seed, uint32_t(op->gid()));
-    return seed;
+    return hash_of(tag(), ops());
 }
 
 template <class TypeTable>
@@ -269,21 +378,68 @@ bool TypeBase<TypeTable>::equal(const TypeBase* other) const {
 //------------------------------------------------------------------------------
 
 template <class Type>
-const Type* TypeTableBase<Type>::unify_base(const Type* type) {
-    auto i = types_.find(type);
-    if (i != types_.end()) {
-        delete type;
-        type = *i;
-        return type;
+size_t TypeTableBase<Type>::num_types() const {
+    size_t result = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        result += shard.size;
+    }
+    return result;
+}
+
+template <class Type>
+size_t TypeTableBase<Type>::num_hits() const {
+    size_t result = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        result += shard.num_hits;
+    }
+    return result;
+}
+
+template <class Type>
+size_t TypeTableBase<Type>::num_misses() const {
+    size_t result = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        result += shard.num_misses;
+    }
+    return result;
+}
+
+template <class Type>
+template<class T, class Eq, class Make>
+const T* TypeTableBase<Type>::unify(int tag, Types ops, uint32_t hash, Eq eq, Make make) {
+    auto& shard = this->shard(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto type = shard.find(hash, [&] (const Type* candidate) {
+        if (candidate->tag() != tag || candidate->num_ops() != ops.size())
+            return false;
+        for (size_t i = 0, e = ops.size(); i != e; ++i) {
+            if (candidate->op(i) != ops[i])
+                return false;
+        }
+        return eq(candidate->template as<T>());
+    });
+
+    if (type != nullptr) {
+        ++shard.num_hits;
+        return type->template as<T>();
     }
 
-    return insert(type);
+    ++shard.num_misses;
+    const T* result = make();
+    assert(result->hash() == hash && "hash broken");
+    shard.insert(result);
+    return result;
 }
 
 template <class Type>
 const Type* TypeTableBase<Type>::insert(const Type* type) {
-    const auto& p = types_.insert(type);
-    assert_unused(p.second && "hash/equal broken");
+    auto& shard = this->shard(type->hash());
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.insert(type);
     return type;
 }
 
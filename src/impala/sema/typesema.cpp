@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #include "impala/ast.h"
 #include "impala/impala.h"
@@ -61,7 +66,7 @@ public:
 
     void expect_known(const Decl* value_decl) {
         if (!value_decl->type()->is_known()) {
-            if (value_decl->symbol() == "return")
+            if (value_decl->symbol() == syms::ret)
                 error(value_decl, "cannot infer a return type, maybe you forgot to mark the function with '-> !'?");
             else
                 error(value_decl, "cannot infer type for '{}'", value_decl->symbol());
@@ -84,6 +89,30 @@ public:
             error(n, "indefinite array '{}' not allowed as {} because its size is statically unknown; use a definite array or a pointer to an indefinite array instead", type, context);
     }
 
+    // loops
+
+    /// Marks @p expr as written and remembers written locals in all enclosing @p WhileExpr%s of the local's function.
+    void write(const Expr* expr) {
+        expr->write();
+        if (auto path = expr->isa<PathExpr>()) {
+            if (auto local = path->value_decl() ? path->value_decl()->isa<LocalDecl>() : nullptr) {
+                for (auto loop : loops_) {
+                    auto& written = loop->written_locals_;
+                    if (loop->continue_decl()->fn() == local->fn() && std::find(written.begin(), written.end(), local) == written.end())
+                        written.push_back(local);
+                }
+            }
+        }
+    }
+
+    /// Flags the enclosing @p WhileExpr if @p local is its break or continue and @p path is not a direct call of it.
+    void use_continuation(const PathExpr* path, const LocalDecl* local) {
+        for (auto loop : loops_) {
+            if ((local == loop->break_decl() || local == loop->continue_decl()) && (path != cur_callee_ || local->fn() != cur_fn_))
+                loop->escapes_ = true;
+        }
+    }
+
     // check wrappers
 
     const Var* check(const ASTTypeParam* ast_type_param) { ast_type_param->check(*this); return ast_type_param->var(); }
@@ -107,9 +136,57 @@ public:
 public:
     const BlockExpr* cur_block_ = nullptr;
     const Fn* cur_fn_ = nullptr;
+    const Expr* cur_callee_ = nullptr;
+    std::vector<const WhileExpr*> loops_;
 };
 
-void type_analysis(const Module* module) { TypeSema().check(module); }
+/**
+ * Checks the top-level items of @p module on up to @p num_threads threads.
+ * Checking only reads the inferred types; the few flags it sets on the AST belong to the item being checked - apart
+ * from @p Decl::write which is atomic.
+ * Each item is checked by its own @p TypeSema into its own diagnostics buffer; afterwards, the diagnostics are printed
+ * in the order of the items - just like @p parse.
+ */
+void type_analysis(const Module* module, size_t num_threads) {
+    const auto& items = module->items();
+    num_threads = std::min(num_threads, items.size());
+    if (num_threads <= 1) {
+        TypeSema().check(module);
+        return;
+    }
+
+    struct Unit {
+        std::ostringstream diagnostics;
+        std::exception_ptr exception;
+    };
+
+    std::vector<Unit> units(items.size());
+    std::atomic<size_t> next = 0;
+    auto work = [&] {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < units.size();) {
+            auto& unit = units[i];
+            DiagnosticsScope diagnostics_scope(unit.diagnostics);
+            try {
+                TypeSema().check(items[i].get());
+            } catch (...) {
+                unit.exception = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t != num_threads; ++t)
+        threads.emplace_back(work);
+    work();
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto& unit : units) {
+        diagnostics() << unit.diagnostics.str();
+        if (unit.exception)
+            std::rethrow_exception(unit.exception);
+    }
+}
 
 template<class T>
 TokenTag token_tag(const T* expr) { return TokenTag(expr->tag()); }
@@ -223,7 +300,7 @@ void Module::check(TypeSema& sema) const {
 
 void ExternBlock::check(TypeSema& sema) const {
     if (!abi().empty()) {
-        if (abi() != "\"C\"" && abi() != "\"device\"" && abi() != "\"thorin\"")
+        if (abi() != syms::abi_c && abi() != syms::abi_device && abi() != syms::abi_thorin)
             error(this, "unknown extern specification");  // TODO: better location
     }
 
@@ -324,6 +401,7 @@ void PathExpr::check(TypeSema& sema) const {
             // if local lies in an outer function go through memory to implement closure
             if (local->is_mut() && local->fn() != sema.cur_fn_)
                 local->take_address();
+            sema.use_continuation(this, local);
         }
     } else
         error(this, "expected value but found '{}'", path());
@@ -337,7 +415,7 @@ void PrefixExpr::check(TypeSema& sema) const {
             rhs()->take_address();
             return;
         case MUT:
-            rhs()->write();
+            sema.write(rhs());
             rhs()->take_address();
             sema.expect_lvalue(rhs(), "operand of '&mut'");
             return;
@@ -347,7 +425,7 @@ void PrefixExpr::check(TypeSema& sema) const {
             sema.expect_ptr(rhs(), "operand of unary '*'");
             return;
         case INC: case DEC: {
-            rhs()->write();
+            sema.write(rhs());
             sema.expect_lvalue(rhs(), "operand of prefix '{}'", tok2str(this));
             sema.expect_num(rhs(),    "operand of prefix '{}'", tok2str(this));
             return;
@@ -422,28 +500,28 @@ void InfixExpr::check(TypeSema& sema) const {
             sema.expect_int_or_bool(rhs(), "right-hand side of bitwise '{}'", tok2str(this));
             return;
         case ASGN: {
-            lhs()->write();
+            sema.write(lhs());
             match_subtype(lhs()->type(), rhs()->type());
             sema.expect_lvalue(lhs(), "assignment");
             return;
         }
         case ADD_ASGN: case SUB_ASGN:
         case MUL_ASGN: case DIV_ASGN: case REM_ASGN:
-            lhs()->write();
+            sema.write(lhs());
             match_subtype(lhs()->type(), rhs()->type());
             sema.expect_num(lhs(),  "left-hand side of binary '{}'", tok2str(this));
             sema.expect_num(rhs(), "right-hand side of binary '{}'", tok2str(this));
             sema.expect_lvalue(lhs(), "assignment '{}'", tok2str(this));
             return;
         case AND_ASGN: case  OR_ASGN: case XOR_ASGN:
-            lhs()->write();
+            sema.write(lhs());
             match_subtype(lhs()->type(), rhs()->type());
             sema.expect_int_or_bool(lhs(),  "left-hand side of binary '{}'", tok2str(this));
             sema.expect_int_or_bool(rhs(), "right-hand side of binary '{}'", tok2str(this));
             sema.expect_lvalue(lhs(), "assignment '{}'", tok2str(this));
             return;
         case SHL_ASGN: case SHR_ASGN:
-            lhs()->write();
+            sema.write(lhs());
             match_subtype(lhs()->type(), rhs()->type());
             sema.expect_int(lhs(),  "left-hand side of binary '{}'", tok2str(this));
             sema.expect_int(rhs(), "right-hand side of binary '{}'", tok2str(this));
@@ -454,7 +532,7 @@ void InfixExpr::check(TypeSema& sema) const {
 }
 
 void PostfixExpr::check(TypeSema& sema) const {
-    lhs()->write();
+    sema.write(lhs());
     sema.check(lhs());
     sema.expect_num(lhs(),    "postfix '{}'", tok2str(this));
     sema.expect_lvalue(lhs(), "postfix '{}'", tok2str(this));
@@ -468,7 +546,7 @@ void CastExpr::check(TypeSema& sema) const {
     auto dst_type = type();
 
     if (dst_type->isa<BorrowedPtrType>() && dst_type->as<BorrowedPtrType>()->is_mut())
-        src()->write();
+        sema.write(src());
 
     // TODO be consistent: dst is first argument, src ist second argument
     auto ptr_to_ptr     = [&] (const Type* a, const Type* b) { return a->isa<PtrType>() && b->isa<PtrType>(); };
@@ -571,7 +649,11 @@ void TypeAppExpr::check(TypeSema& /*sema*/) const {
 }
 
 void MapExpr::check(TypeSema& sema) const {
-    auto ltype = unpack_ref_type(sema.check(lhs()));
+    const Type* ltype;
+    {
+        THORIN_PUSH(sema.cur_callee_, lhs()->skip_rvalue());
+        ltype = unpack_ref_type(sema.check(lhs()));
+    }
 
     for (auto&& arg : args())
         sema.check(arg.get());
@@ -688,14 +770,22 @@ void MatchExpr::check(TypeSema& sema) const {
 }
 
 void WhileExpr::check(TypeSema& sema) const {
-    sema.check(cond());
-    sema.expect_bool(cond(), "while-condition");
     sema.check(break_decl());
     sema.check(continue_decl());
+    sema.loops_.push_back(this);
+    sema.check(cond());
+    sema.expect_bool(cond(), "while-condition");
     sema.check(body());
+    sema.loops_.pop_back();
 
     if (!is_no_ret_or_type_error(body()->type()))
         sema.expect_unit(body(), "body type in a while-expression");
+
+    // CodeGen passes the written locals as SSA values along with direct calls of break and continue only
+    if (escapes_) {
+        for (auto local : written_locals_)
+            local->take_address();
+    }
 }
 
 void ForExpr::check(TypeSema& sema) const {
@@ -843,7 +933,7 @@ void AsmStmt::check(TypeSema& sema) const {
         else
             error(output->expr(), "output expression of an asm statement must be an lvalue");
 
-        output->expr()->write();
+        sema.write(output->expr());
         check_correct_asm_type(type, output->expr());
     }
 
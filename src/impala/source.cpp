@@ -0,0 +1,85 @@
+#include "impala/source.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "impala/loc.h"
+
+namespace impala {
+
+Source::Source(const char* filename)
+    : filename_(filename)
+{
+#ifndef _WIN32
+    int fd = ::open(filename, O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error(std::string("cannot open '") + filename + "': " + std::strerror(errno));
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) {
+            ::close(fd);
+            begin_ = end_ = buffer_.data();
+            return;
+        }
+
+        auto addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            ::close(fd);
+            ::madvise(addr, st.st_size, MADV_SEQUENTIAL);
+            begin_  = static_cast<const char*>(addr);
+            end_    = begin_ + st.st_size;
+            mapped_ = true;
+            return;
+        }
+    }
+    ::close(fd);
+#endif // _WIN32
+
+    // not a regular file or mmap failed: read it the old-fashioned way
+    std::ifstream stream(filename, std::ios::binary);
+    if (!stream)
+        throw std::runtime_error(std::string("cannot open '") + filename + "'");
+    read(stream);
+}
+
+uint32_t Source::base() const {
+    if (base_ == 0)
+        base_ = Loc::add_file(filename_, view());
+    return base_;
+}
+
+Source::Source(std::istream& stream, const char* filename)
+    : filename_(filename)
+{
+    if (!stream)
+        throw std::runtime_error("stream is bad");
+    read(stream);
+}
+
+Source::~Source() {
+#ifndef _WIN32
+    if (mapped_)
+        ::munmap(const_cast<char*>(begin_), size());
+#endif
+}
+
+void Source::read(std::istream& stream) {
+    buffer_.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    if (stream.bad())
+        throw std::runtime_error("stream is bad");
+    begin_ = buffer_.data();
+    end_   = begin_ + buffer_.size();
+}
+
+}
@@ -0,0 +1,55 @@
+#ifndef IMPALA_SOURCE_H
+#define IMPALA_SOURCE_H
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <string_view>
+
+namespace impala {
+
+/**
+ * Contiguous, read-only buffer holding the contents of one input file.
+ * A @p Source either memory-maps its file, owns a copy of a @c std::istream's contents or merely views a buffer
+ * provided by the caller.
+ * The @p Lexer scans this buffer with raw pointers.
+ */
+class Source {
+public:
+    /// Memory-maps @p filename; falls back to reading the whole file if mapping is not possible.
+    explicit Source(const char* filename);
+    /// Reads the whole @p stream into an internal buffer.
+    Source(std::istream& stream, const char* filename);
+    /// Views @p buffer which must outlive this @p Source.
+    Source(std::string_view buffer, const char* filename)
+        : filename_(filename)
+        , begin_(buffer.data())
+        , end_(buffer.data() + buffer.size())
+    {}
+    Source(const Source&) = delete;
+    Source& operator=(const Source&) = delete;
+    ~Source();
+
+    const char* filename() const { return filename_; }
+    const char* begin() const { return begin_; }
+    const char* end() const { return end_; }
+    size_t size() const { return end_ - begin_; }
+    std::string_view view() const { return {begin_, size()}; }
+    bool is_mapped() const { return mapped_; }
+    /// Offset of the first character in the global @p Loc space; registers the file via @p Loc::add_file on first use.
+    uint32_t base() const;
+
+private:
+    void read(std::istream&);
+
+    const char* filename_;
+    const char* begin_ = nullptr;
+    const char* end_ = nullptr;
+    std::string buffer_; ///< Only used if the contents could not be mapped.
+    bool mapped_ = false;
+    mutable uint32_t base_ = 0;
+};
+
+}
+
+#endif
@@ -1,27 +1,145 @@
 #include "impala/symbol.h"
 
-#include <iomanip>
-#include <sstream>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace thorin {
 
-Symbol::Table Symbol::table_;
+/**
+ * Concurrent string interner behind @p Symbol.
+ * The table is split into @c num_shards shards selected by the top bits of a string's hash.
+ * Each shard is guarded by its own mutex, owns an open-addressing table of @p Symbol::Header%s and bump-allocates the
+ * headers plus the string bytes from its own arena.
+ * Interned strings never move or die until program exit, so a @p Symbol may be passed between threads freely.
+ */
+class Interner {
+public:
+    using Header = Symbol::Header;
 
-#ifdef _MSC_VER
-static const char* duplicate(const char* s) { return _strdup(s); }
-#else // _MSC_VER
-static const char* duplicate(const char* s) { return strdup(s); }
-#endif // _MSC_VER
+    static constexpr int shard_bits = 6;
+    static constexpr size_t num_shards = 1 << shard_bits;
+    static constexpr size_t block_size = 64 * 1024;
 
-void Symbol::insert(const char* s) {
-    auto i = table_.map.find(s);
-    if (i == table_.map.end())
-        i = table_.map.emplace(duplicate(s)).first;
-    str_ = *i;
-}
+    Interner()
+        : empty_(intern("")) // the empty Symbol gets ID 0
+    {}
+
+    static Interner& get() {
+        static Interner interner;
+        return interner;
+    }
+
+    /// FNV-1a; identifiers are short and this is cheap enough.
+    static uint32_t hash(std::string_view str) {
+        uint32_t h = 2166136261u;
+        for (auto c : str)
+            h = (h ^ uint8_t(c)) * 16777619u;
+        return h;
+    }
+
+    const char* intern(std::string_view str) {
+        auto h = hash(str);
+        auto& shard = shards_[h >> (32 - shard_bits)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        if (auto header = shard.find(str, h))
+            return reinterpret_cast<const char*>(header + 1);
+
+        auto header = shard.allocate(str.size());
+        header->hash = h;
+        header->id   = next_id_.fetch_add(1, std::memory_order_relaxed);
+        header->size = uint32_t(str.size());
+        auto result = reinterpret_cast<char*>(header + 1);
+        std::memcpy(result, str.data(), str.size());
+        result[str.size()] = '\0';
+        shard.insert(header);
+        return result;
+    }
+
+    const char* empty() const { return empty_; }
+    size_t size() const { return next_id_.load(std::memory_order_relaxed); }
+
+private:
+    struct Shard {
+        const Header* find(std::string_view str, uint32_t h) const {
+            if (slots.empty())
+                return nullptr;
+            for (size_t i = h & (slots.size() - 1);; i = (i + 1) & (slots.size() - 1)) {
+                auto header = slots[i];
+                if (header == nullptr)
+                    return nullptr;
+                if (header->hash == h && header->size == str.size()
+                        && std::memcmp(header + 1, str.data(), str.size()) == 0)
+                    return header;
+            }
+        }
+
+        void insert(const Header* header) {
+            if (2 * (size + 1) > slots.size())
+                rehash(slots.empty() ? 64 : 2 * slots.size());
+            size_t i = header->hash & (slots.size() - 1);
+            while (slots[i] != nullptr)
+                i = (i + 1) & (slots.size() - 1);
+            slots[i] = header;
+            ++size;
+        }
+
+        void rehash(size_t capacity) {
+            std::vector<const Header*> old(capacity, nullptr);
+            old.swap(slots);
+            size = 0;
+            for (auto header : old) {
+                if (header != nullptr)
+                    insert(header);
+            }
+        }
 
-std::string Symbol::remove_quotation() const {
-    std::string str = str_;
+        Header* allocate(size_t size) {
+            size_t num_bytes = (sizeof(Header) + size + 1 + alignof(Header) - 1) & ~(alignof(Header) - 1);
+            if (num_bytes > block_size) {
+                blocks.emplace_back(new char[num_bytes]);
+                return reinterpret_cast<Header*>(blocks.back().get());
+            }
+            if (cur == nullptr || size_t(end - cur) < num_bytes) {
+                blocks.emplace_back(new char[block_size]);
+                cur = blocks.back().get();
+                end = cur + block_size;
+            }
+            auto result = reinterpret_cast<Header*>(cur);
+            cur += num_bytes;
+            return result;
+        }
+
+        std::mutex mutex;
+        std::vector<const Header*> slots;
+        size_t size = 0;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char* cur = nullptr;
+        char* end = nullptr;
+    };
+
+    Shard shards_[num_shards];
+    std::atomic<uint32_t> next_id_ = 0;
+    const char* empty_;
+};
+
+Symbol::Symbol()
+    : str_(Interner::get().empty())
+{}
+
+void Symbol::insert(std::string_view s) { str_ = Interner::get().intern(s); }
+
+size_t Symbol::num_symbols() { return Interner::get().size(); }
+
+bool Symbol::is_anonymous() const { return *this == impala::syms::anonymous; }
+
+std::string Symbol::remove_quotation() const { return std::string(unquoted()); }
+
+std::string_view Symbol::unquoted() const {
+    auto str = view();
     if (!str.empty() && str.front() == '"') {
         assert(str.size() >= 2 && str.back() == '"');
         str = str.substr(1, str.size()-2);
@@ -30,3 +148,11 @@ std::string Symbol::remove_quotation() const {
 }
 
 }
+
+namespace impala::syms {
+
+#define IMPALA_SYMBOL(name, str) const thorin::Symbol name(str);
+IMPALA_SYMBOLS(IMPALA_SYMBOL)
+#undef IMPALA_SYMBOL
+
+}
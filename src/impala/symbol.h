@@ -1,7 +1,9 @@
 #ifndef THORIN_UTIL_SYMBOL_H
 #define THORIN_UTIL_SYMBOL_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 #include "thorin/util/hash.h"
 
@@ -10,44 +12,58 @@ namespace thorin {
 class Symbol {
 public:
     struct Hash {
-        static uint32_t hash(Symbol s) { return thorin::hash(s.c_str()); }
+        static uint32_t hash(Symbol s) { return s.hash(); }
         static bool eq(Symbol s1, Symbol s2) { return s1 == s2; }
         static Symbol sentinel() { return Symbol(/*dummy*/23); }
     };
 
-    Symbol() { insert(""); }
+    Symbol();
     Symbol(const char* str) { insert(str); }
-    Symbol(const std::string& str) { insert(str.c_str()); }
+    Symbol(const std::string& str) { insert(std::string_view(str)); }
+    Symbol(std::string_view str) { insert(str); }
 
     const char* c_str() const { return str_; }
     std::string str() const { return str_; }
-    operator bool() const { return *this != Symbol(""); }
+    std::string_view view() const { return {str_, header()->size}; }
+    size_t size() const { return header()->size; }
+    /// Stable ID of this Symbol; IDs are handed out consecutively starting with 0 for the empty Symbol.
+    uint32_t id() const { return header()->id; }
+    /// Hash of the string computed once when it was interned.
+    uint32_t hash() const { return header()->hash; }
+    operator bool() const { return !empty(); }
     bool operator==(Symbol symbol) const { return c_str() == symbol.c_str(); }
     bool operator!=(Symbol symbol) const { return c_str() != symbol.c_str(); }
-    bool operator==(const char* s) const { return c_str() == Symbol(s).c_str(); }
-    bool operator!=(const char* s) const { return c_str() != Symbol(s).c_str(); }
+    /// Compares the characters; in contrast to constructing a Symbol from @p s, this does not intern @p s.
+    bool operator==(const char* s) const { return view() == s; }
+    bool operator!=(const char* s) const { return view() != s; }
     bool empty() const { return *str_ == '\0'; }
-    bool is_anonymous() { return (*this) == "_"; }
+    bool is_anonymous() const;
     std::string remove_quotation() const;
+    /// Like @p remove_quotation but without copying the characters.
+    std::string_view unquoted() const;
+
+    /// Number of interned Symbols; all IDs are below this number.
+    static size_t num_symbols();
 
 private:
     Symbol(int /* just a dummy */)
         : str_((const char*)(1))
     {}
 
-    struct Table {
-        ~Table() {
-            for (auto s : map)
-                free((void*) const_cast<char*>(s));
-        }
-
-        HashSet<const char*, StrHash> map;
+    /// Interned strings are stored right behind this header.
+    struct Header {
+        uint32_t hash;
+        uint32_t id;
+        uint32_t size;
     };
 
-    void insert(const char* str);
+    const Header* header() const { return reinterpret_cast<const Header*>(str_) - 1; }
+    void insert(const char* str) { insert(std::string_view(str)); }
+    void insert(std::string_view str);
 
     const char* str_;
-    static Table table_;
+
+    friend class Interner;
 };
 
 inline Symbol operator+(Symbol s1, Symbol s2) { return std::string(s1.c_str()) + s2.str(); }
@@ -60,4 +76,40 @@ using SymbolMap = HashMap<Symbol, T>;
 
 }
 
+namespace impala::syms {
+
+/// Well-known Symbols which are compared against on hot paths.
+#define IMPALA_SYMBOLS(f) \
+    f(anonymous,       "_") \
+    f(main,            "main") \
+    f(ret,             "return") \
+    f(lambda,          "lambda") \
+    f(abi_c,           "\"C\"") \
+    f(abi_device,      "\"device\"") \
+    f(abi_thorin,      "\"thorin\"") \
+    f(atomic,          "atomic") \
+    f(bitcast,         "bitcast") \
+    f(cmpxchg,         "cmpxchg") \
+    f(fast_math,       "fast_math") \
+    f(fp_contract,     "fp_contract") \
+    f(fp_strict,       "fp_strict") \
+    f(insert,          "insert") \
+    f(no_signed_zeros, "no_signed_zeros") \
+    f(no_unsigned_wrap, "no_unsigned_wrap") \
+    f(pe_info,         "pe_info") \
+    f(pe_known,        "pe_known") \
+    f(reciprocal_math, "reciprocal_math") \
+    f(reserve_shared,  "reserve_shared") \
+    f(rev_diff,        "rev_diff") \
+    f(select,          "select") \
+    f(size_of,         "sizeof") \
+    f(undef,           "undef") \
+    f(unsigned_wrap,   "unsigned_wrap")
+
+#define IMPALA_SYMBOL(name, str) extern const thorin::Symbol name;
+IMPALA_SYMBOLS(IMPALA_SYMBOL)
+#undef IMPALA_SYMBOL
+
+}
+
 #endif
@@ -1,9 +1,13 @@
 #include "impala/token.h"
 
-#include <algorithm>
+#include <array>
 #include <cerrno>
+#include <charconv>
 #include <cstdlib>
+#include <iterator>
 #include <limits>
+#include <type_traits>
+#include <vector>
 
 #include "thorin/util/cast.h"
 
@@ -19,16 +23,109 @@ Token::Token(Loc loc, Tag tok)
     , tag_(tok)
 {}
 
-Token::Token(Loc loc, const std::string& str)
+/*
+ * keywords
+ */
+
+namespace {
+
+struct Keyword {
+    std::string_view str;
+    TokenTag tag;
+};
+
+}
+
+static constexpr Keyword keywords[] = {
+#define IMPALA_KEY(tok, str)      { str, Token::tok },
+#define IMPALA_TYPE(itype, atype) { #itype, Token::TYPE_##itype },
+#include "impala/tokenlist.h"
+    // type aliases - they must come after the types as they override Token::tok2str
+    { "int",    Token::TYPE_i32 },
+    { "uint",   Token::TYPE_u32 },
+    { "half",   Token::TYPE_f16 },
+    { "float",  Token::TYPE_f32 },
+    { "double", Token::TYPE_f64 },
+    // special tokens
+    { "as",     Token::AS },
+    { "mut",    Token::MUT },
+};
+
+static constexpr size_t num_keywords = std::size(keywords);
+static std::vector<Symbol> keyword_symbols; // filled by Token::init
+
+/*
+ * All keywords are at least two characters long and no two keywords agree in length, first, second and last character.
+ * These are packed into a 32-bit key and multiplied with a seed such that the top 8 bits of the product are a
+ * perfect hash.
+ * The seed is searched at compile time.
+ */
+
+static constexpr int keyword_hash_bits = 8;
+static constexpr size_t keyword_min_size = 2;
+static constexpr size_t keyword_max_size = 8;
+
+static constexpr bool keyword_sizes_in_range() {
+    for (const auto& keyword : keywords) {
+        if (keyword.str.size() < keyword_min_size || keyword.str.size() > keyword_max_size)
+            return false;
+    }
+    return true;
+}
+static_assert(keyword_sizes_in_range(), "adjust keyword_min_size/keyword_max_size");
+
+static constexpr uint32_t keyword_hash(std::string_view str, uint32_t seed) {
+    uint32_t key = uint32_t(uint8_t(str[0])) << 24 | uint32_t(uint8_t(str[1])) << 16
+                 | uint32_t(uint8_t(str.back())) << 8 | uint32_t(str.size());
+    return (key * seed) >> (32 - keyword_hash_bits);
+}
+
+static constexpr uint32_t find_keyword_seed() {
+    for (uint32_t seed = 1; seed < (1u << 16); seed += 2) {
+        bool used[1 << keyword_hash_bits] = {};
+        bool perfect = true;
+        for (size_t i = 0; perfect && i != num_keywords; ++i) {
+            auto h = keyword_hash(keywords[i].str, seed);
+            perfect = !used[h];
+            used[h] = true;
+        }
+        if (perfect)
+            return seed;
+    }
+    return 0;
+}
+
+static constexpr uint32_t keyword_seed = find_keyword_seed();
+static_assert(keyword_seed != 0, "no perfect hash for the keywords found - adjust keyword_hash");
+
+/// Maps a hash to its index in @c keywords plus one; zero denotes an empty slot.
+static constexpr std::array<uint8_t, 1 << keyword_hash_bits> keyword_slots = [] {
+    std::array<uint8_t, 1 << keyword_hash_bits> slots = {};
+    for (size_t i = 0; i != num_keywords; ++i)
+        slots[keyword_hash(keywords[i].str, keyword_seed)] = uint8_t(i + 1);
+    return slots;
+}();
+
+/// Index of @p str in @c keywords or -1 if @p str is not a keyword.
+static int find_keyword(std::string_view str) {
+    if (str.size() < keyword_min_size || str.size() > keyword_max_size)
+        return -1;
+    int i = int(keyword_slots[keyword_hash(str, keyword_seed)]) - 1;
+    return i >= 0 && keywords[i].str == str ? i : -1;
+}
+
+Token::Token(Loc loc, std::string_view spelling)
+    : Token(loc, spelling, find_keyword(spelling))
+{}
+
+Token::Token(Loc loc, std::string_view spelling, int keyword)
     : loc_(loc)
-    , symbol_(str)
+    , symbol_(keyword < 0 ? Symbol(spelling) : keyword_symbols[keyword])
+    , spelling_(spelling.data())
+    , size_(spelling.size())
+    , tag_(keyword < 0 ? Token::ID : keywords[keyword].tag)
 {
-    assert(!str.empty());
-    auto i = keywords_.find(str);
-    if (i == keywords_.end())
-        tag_ = Token::ID;
-    else
-        tag_ = i->second;
+    assert(!spelling.empty());
 }
 
 template<class T, class V>
@@ -36,82 +133,127 @@ static bool inrange(V val) {
     return std::numeric_limits<T>::lowest() <= val && val <= std::numeric_limits<T>::max();
 }
 
-Token::Token(Loc loc, Tag tag, const std::string& str)
+/**
+ * Digits of a numeric literal without its @c 0b/0o/0x prefix and without @c _ separators.
+ * The type suffix is still part of the digits; the @c from_chars routines simply stop there.
+ * The digits are only copied if they contain separators; short literals are copied to a stack buffer.
+ */
+class Digits {
+public:
+    Digits(std::string_view spelling) {
+        if (spelling.size() >= 2 && spelling[0] == '0') {
+            switch (spelling[1]) {
+                case 'b': base_ =  2; spelling.remove_prefix(2); break;
+                case 'o': base_ =  8; spelling.remove_prefix(2); break;
+                case 'x': base_ = 16; spelling.remove_prefix(2); break;
+                default: break;
+            }
+        }
+
+        if (spelling.find('_') == std::string_view::npos) {
+            begin_ = spelling.data();
+            end_   = begin_ + spelling.size();
+            return;
+        }
+
+        char* dst = spelling.size() <= sizeof(buffer_) ? buffer_ : (heap_.resize(spelling.size()), heap_.data());
+        begin_ = dst;
+        for (auto c : spelling) {
+            if (c != '_')
+                *dst++ = c;
+        }
+        end_ = dst;
+    }
+
+    const char* begin() const { return begin_; }
+    const char* end() const { return end_; }
+    int base() const { return base_; }
+
+private:
+    const char* begin_;
+    const char* end_;
+    int base_ = 10;
+    char buffer_[64];
+    std::string heap_;
+};
+
+/// Converts @p digits to @p val; returns @c false if the value is out of range.
+template<class T>
+static bool decode_int(const Digits& digits, T& val) {
+    auto [ptr, ec] = std::from_chars(digits.begin(), digits.end(), val, digits.base());
+    if (ec != std::errc()) // without any digits the lexer has already complained
+        val = 0;
+    return ec != std::errc::result_out_of_range;
+}
+
+/// Converts @p digits to @p val; returns @c false if the value is out of range.
+template<class T>
+static bool decode_float(const Digits& digits, T& val) {
+    if (digits.base() != 10) {
+        // integral floating point literals like 0x10h
+        uint64_t uval;
+        bool ok = decode_int(digits, uval);
+        val = T(uval);
+        return ok;
+    }
+
+#if defined(__cpp_lib_to_chars)
+    auto [ptr, ec] = std::from_chars(digits.begin(), digits.end(), val);
+    if (ec != std::errc())
+        val = 0;
+    return ec != std::errc::result_out_of_range;
+#else
+    // floating point from_chars is not available: strtod & co. need a null-terminated string
+    std::string str(digits.begin(), digits.end());
+    errno = 0;
+    if constexpr (std::is_same<T, float>::value)
+        val = std::strtof(str.c_str(), nullptr);
+    else
+        val = std::strtod(str.c_str(), nullptr);
+    return errno == 0;
+#endif
+}
+
+Token::Token(Loc loc, Tag tag, std::string_view spelling)
     : loc_(loc)
-    , symbol_(str)
+    , spelling_(spelling.data())
+    , size_(spelling.size())
     , tag_(tag)
 {
-    using namespace std;
     using thorin::half;
 
     if (tag_ == LIT_str || tag_ == LIT_char)
         return;
 
-    std::string literal;
-    int base = 10;
-    auto begin = str.begin();
-
-    // find out base and move begin iterator to the actual number
-    if (str.size() >= 2) {
-        if (str[0] == '0') {
-            if (str[1] == 'b') {
-                base = 2;
-                begin += 2;
-            } else if (str[1] == 'o') {
-                base = 8;
-                begin += 2;
-            } else if (str[1] == 'x') {
-                base = 16;
-                begin += 2;
-            }
-        }
-    }
-
-    // remove underscores and '0b'/'0o'/'0x' prefix if applicable
-    std::copy_if(begin, str.end(), std::back_inserter(literal), [](char c) { return c != '_'; });
-    auto nptr = &literal.front();
-
-    bool err = 0;
-    errno = 0;
-    int64_t ival; uint64_t uval; half hval; float fval; double dval;
+    Digits digits(spelling);
+    bool ok = true;
+    int64_t ival;
+    uint64_t uval;
+    float fval;
+    double dval;
 
     switch (tag_) {
-        case LIT_i8:
-        case LIT_i16:
-        case LIT_i32:
-        case LIT_i64:
-            ival = strtoll(nptr, 0, base);
-            err = errno;
-            break;
-        case LIT_u8:
-        case LIT_u16:
-        case LIT_u32:
-        case LIT_u64:
-            uval = strtoull(nptr, 0, base);
-            err = errno;
+        case LIT_i8:  ok = decode_int(digits, ival) && inrange<  int8_t>(ival); val_ = bitcast<u64>(  int8_t(ival)); break;
+        case LIT_i16: ok = decode_int(digits, ival) && inrange< int16_t>(ival); val_ = bitcast<u64>( int16_t(ival)); break;
+        case LIT_i32: ok = decode_int(digits, ival) && inrange< int32_t>(ival); val_ = bitcast<u64>( int32_t(ival)); break;
+        case LIT_i64: ok = decode_int(digits, ival) && inrange< int64_t>(ival); val_ = bitcast<u64>( int64_t(ival)); break;
+        case LIT_u8:  ok = decode_int(digits, uval) && inrange< uint8_t>(uval); val_ = bitcast<u64>( uint8_t(uval)); break;
+        case LIT_u16: ok = decode_int(digits, uval) && inrange<uint16_t>(uval); val_ = bitcast<u64>(uint16_t(uval)); break;
+        case LIT_u32: ok = decode_int(digits, uval) && inrange<uint32_t>(uval); val_ = bitcast<u64>(uint32_t(uval)); break;
+        case LIT_u64: ok = decode_int(digits, uval);                            val_ = bitcast<u64>(uint64_t(uval)); break;
+        case LIT_f16: {
+            ok = decode_float(digits, fval);
+            auto hval = half(fval);
+            ok &= inrange<half>(hval);
+            val_ = bitcast<u64>(hval);
             break;
-        case LIT_f16: hval = strtof(symbol_.c_str(), 0); err = errno; break; // TODO: errno for half not correctly set
-        case LIT_f32: fval = strtof(symbol_.c_str(), 0); err = errno; break;
-        case LIT_f64: dval = strtod(symbol_.c_str(), 0); err = errno; break;
-        default: THORIN_UNREACHABLE;
-    }
-
-    switch (tag_) {
-        case LIT_i8:  val_ = bitcast<u64>(  int8_t(ival)); err |= !inrange<  int8_t>(ival); break;
-        case LIT_i16: val_ = bitcast<u64>( int16_t(ival)); err |= !inrange< int16_t>(ival); break;
-        case LIT_i32: val_ = bitcast<u64>( int32_t(ival)); err |= !inrange< int32_t>(ival); break;
-        case LIT_i64: val_ = bitcast<u64>( int64_t(ival)); err |= !inrange< int64_t>(ival); break;
-        case LIT_u8:  val_ = bitcast<u64>( uint8_t(uval)); err |= !inrange< uint8_t>(uval); break;
-        case LIT_u16: val_ = bitcast<u64>(uint16_t(uval)); err |= !inrange<uint16_t>(uval); break;
-        case LIT_u32: val_ = bitcast<u64>(uint32_t(uval)); err |= !inrange<uint32_t>(uval); break;
-        case LIT_u64: val_ = bitcast<u64>(uint64_t(uval)); err |= !inrange<uint64_t>(uval); break;
-        case LIT_f16: val_ = bitcast<u64>(    half(hval)); err |= !inrange<    half>(hval); break;
-        case LIT_f32: val_ = bitcast<u64>(   float(fval)); err |= !inrange<   float>(fval); break;
-        case LIT_f64: val_ = bitcast<u64>(  double(dval)); err |= !inrange<  double>(dval); break;
+        }
+        case LIT_f32: ok = decode_float(digits, fval) && inrange< float>(fval); val_ = bitcast<u64>( float(fval)); break;
+        case LIT_f64: ok = decode_float(digits, dval) && inrange<double>(dval); val_ = bitcast<u64>(double(dval)); break;
         default: THORIN_UNREACHABLE;
     }
 
-    if (err)
+    if (!ok)
         switch (tag_) {
 #define IMPALA_LIT(itype, atype) \
             case LIT_##itype: error(loc, "literal out of range for type '{}'", #itype); return;
@@ -127,7 +269,6 @@ Token::Token(Loc loc, Tag tag, const std::string& str)
 int Token::tok2op_[Num];
 Token::Tag2Str Token::tok2str_;
 Token::Tag2Sym Token::tok2sym_;
-Token::Sym2Tag Token::keywords_;
 Token::Sym2Tag Token::sym2lit_;
 Token::Sym2Tag Token::sym2flit_;
 
@@ -165,17 +306,15 @@ void Token::init() {
 #define IMPALA_INFIX(     tok, str, prec) insert(tok, str); tok2op_[tok] |= Infix;
 #define IMPALA_INFIX_ASGN(tok, str)       insert(tok, str); tok2op_[tok] |= Infix | Asgn_Op;
 #define IMPALA_MISC(      tok, str)       insert(tok, str);
-#define IMPALA_KEY(       tok, str)       insert_key(tok, str);
 #define IMPALA_LIT(       tok, atype)     tok2str_[LIT_##tok] = Symbol("<literal>").c_str();
-#define IMPALA_TYPE(itype, atype)         insert_key(TYPE_ ## itype, #itype );
 #include "impala/tokenlist.h"
 
-    // type aliases
-    insert_key(TYPE_i32, "int");
-    insert_key(TYPE_u32, "uint");
-    insert_key(TYPE_f16, "half");
-    insert_key(TYPE_f32, "float");
-    insert_key(TYPE_f64, "double");
+    // keywords and types including aliases
+    keyword_symbols.clear();
+    for (const auto& keyword : keywords) {
+        keyword_symbols.emplace_back(keyword.str);
+        tok2str_[keyword.tag] = keyword_symbols.back().c_str();
+    }
 
     // literals
     sym2lit_["i"]   = LIT_i32; sym2lit_["u"]   = LIT_u32;
@@ -193,15 +332,6 @@ void Token::init() {
     // special tokens
     tok2str_[ID]         = Symbol("<identifier>").c_str();
     insert(Eof, "<end of file>");
-    insert_key(AS, "as");
-    insert_key(MUT, "mut");
-}
-
-void Token::insert_key(TokenTag tok, const char* str) {
-    Symbol s = str;
-    assert(keywords_.find(s) == keywords_.end() && "already inserted");
-    keywords_[s] = tok;
-    tok2str_ [tok] = s.c_str();
 }
 
 Symbol Token::insert(TokenTag tok, const char* str) {
@@ -231,6 +361,8 @@ const char* Token::tok2str(TokenTag tag) {
 std::ostream& operator<<(std::ostream& os, const TokenTag& tag) { return os << Token::tok2str(tag); }
 
 std::ostream& operator<<(std::ostream& os, const Token& tok) {
+    if (tok.size_ != 0)
+        return os << tok.spelling();
     const char* sym = tok.symbol().c_str();
     if (std::strcmp(sym, "") == 0)
         return os << Symbol(Token::tok2str_[tok.tag()]).c_str();
@@ -3,6 +3,7 @@
 
 #include <ostream>
 #include <string>
+#include <string_view>
 
 #include "impala/loc.h"
 #include "impala/symbol.h"
@@ -42,13 +43,16 @@ public:
     Token() {}
     /// Create an operator token
     Token(Loc loc, Tag tok);
-    /// Create an identifier or a keyword (depends on \p str)
-    Token(Loc loc, const std::string& str);
-    /// Create a literal
-    Token(Loc loc, Tag type, const std::string& str);
+    /// Create an identifier or a keyword (depends on \p spelling)
+    Token(Loc loc, std::string_view spelling);
+    /// Create a literal; its value is directly converted from \p spelling
+    Token(Loc loc, Tag type, std::string_view spelling);
 
     Loc loc() const { return loc_; }
+    /// Interned name of identifiers, keywords and operators; empty for literals.
     Symbol symbol() const { return symbol_; }
+    /// Slice of the source buffer this token was lexed from; only valid as long as the @p Source is alive.
+    std::string_view spelling() const { return {spelling_, size_}; }
     template<class T = uint64_t> T get() const { return thorin::bitcast<T>(val_); }
     Tag tag() const { return tag_; }
     operator Tag() const { return tag_; }
@@ -80,12 +84,16 @@ public:
     bool operator!=(const Token& t) const { return tag_ != t; }
 
 private:
+    /// Create an identifier or a keyword; @p keyword is the index of @p spelling in the keyword table or -1.
+    Token(Loc loc, std::string_view spelling, int keyword);
+
     static void init();
     static Symbol insert(Tag tok, const char* str);
-    static void insert_key(Tag tok, const char* str);
 
     Loc loc_;
     Symbol symbol_;
+    const char* spelling_ = nullptr;
+    uint32_t size_ = 0;
     Tag tag_;
     uint64_t val_;
 
@@ -95,7 +103,6 @@ private:
     static int tok2op_[Num];
     static Tag2Str tok2str_; // TODO do we need this thing?
     static Tag2Sym tok2sym_;
-    static Sym2Tag keywords_;
     static Sym2Tag sym2lit_; ///< Table of \em all (including floating) suffixes for literals.
     static Sym2Tag sym2flit_;///< Table of suffixes for \em floating point literals.
 
@@ -125,6 +125,7 @@ IMPALA_MISC(COLON,        ":")
 IMPALA_MISC(DOUBLE_COLON, "::")
 IMPALA_MISC(COMMA,        ",")
 IMPALA_MISC(DOTDOT,       "..")
+IMPALA_MISC(HASH,         "#")
 
 #undef IMPALA_MISC
 
@@ -0,0 +1,106 @@
+#include "impala/trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace impala {
+
+namespace {
+
+struct Event {
+    const char* category;
+    std::string name;
+    Loc loc;
+    double begin; ///< Microseconds since @p Trace::enable.
+    double duration;
+    uint32_t tid;
+};
+
+std::atomic<bool> trace_enabled = false;
+std::chrono::steady_clock::time_point trace_start;
+std::mutex trace_mutex;
+std::vector<Event> trace_events;
+
+double now() { return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - trace_start).count(); }
+
+/// Small, stable number of the calling thread; the main thread usually gets 0.
+uint32_t thread_id() {
+    static std::atomic<uint32_t> next = 0;
+    static thread_local uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void write_string(std::ostream& os, std::string_view str) {
+    os << '"';
+    for (auto c : str) {
+        switch (c) {
+            case '"':  os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n";  break;
+            case '\t': os << "\\t";  break;
+            default:   os << c;
+        }
+    }
+    os << '"';
+}
+
+}
+
+void Trace::enable() {
+    trace_start = std::chrono::steady_clock::now();
+    thread_id();
+    trace_enabled.store(true, std::memory_order_release);
+}
+
+bool Trace::is_enabled() { return trace_enabled.load(std::memory_order_acquire); }
+
+void Trace::write(std::ostream& os) {
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    // microseconds down to nanoseconds; the default precision switches to exponents after one second
+    auto flags = os.flags(std::ios::fixed);
+    auto precision = os.precision(3);
+    os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    for (size_t i = 0, e = trace_events.size(); i != e; ++i) {
+        const auto& event = trace_events[i];
+        os << (i == 0 ? "\n" : ",\n") << "{\"name\": ";
+        write_string(os, event.name);
+        os << ", \"cat\": \"" << event.category << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << event.tid
+           << ", \"ts\": " << event.begin << ", \"dur\": " << event.duration;
+        if (event.loc.is_set()) {
+            auto loc = event.loc.resolve();
+            os << ", \"args\": {\"file\": ";
+            write_string(os, loc.filename);
+            os << ", \"line\": " << loc.front_line << ", \"col\": " << loc.front_col << "}";
+        }
+        os << "}";
+    }
+    os << "\n]}\n";
+    os.precision(precision);
+    os.flags(flags);
+}
+
+Trace::Span::Span(const char* category, std::string_view name, Loc loc)
+    : category_(category)
+    , loc_(loc)
+    , begin_(0.0)
+    , active_(Trace::is_enabled())
+{
+    if (active_) {
+        name_ = name;
+        begin_ = now();
+    }
+}
+
+Trace::Span::~Span() {
+    if (active_) {
+        auto end = now();
+        auto tid = thread_id();
+        std::lock_guard<std::mutex> lock(trace_mutex);
+        trace_events.push_back({category_, std::move(name_), loc_, begin_, end - begin_, tid});
+    }
+}
+
+}
@@ -0,0 +1,44 @@
+#ifndef IMPALA_TRACE_H
+#define IMPALA_TRACE_H
+
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "impala/loc.h"
+
+namespace impala {
+
+/**
+ * Records spans of compiler work as Chrome trace events which chrome://tracing and https://ui.perfetto.dev display.
+ * Tracing is off unless @p enable has been called; until then, a @p Span does nothing.
+ * Thread-safe: each thread shows up as a track of its own.
+ */
+class Trace {
+public:
+    /// Starts recording; timestamps are relative to this call.
+    static void enable();
+    static bool is_enabled();
+    /// Writes all spans recorded so far in the JSON object format of the trace-event specification.
+    static void write(std::ostream&);
+
+    /// Records its lifetime as a span @p name within @p category; @p loc is attached as source location if set.
+    class Span {
+    public:
+        Span(const char* category, std::string_view name, Loc loc = {});
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+        ~Span();
+
+    private:
+        const char* category_;
+        std::string name_;
+        Loc loc_;
+        double begin_;
+        bool active_;
+    };
+};
+
+}
+
+#endif
@@ -0,0 +1,38 @@
+#!/usr/bin/env python3
+
+# Checks that parallel type inference and checking do not change the result:
+# each test file is compiled with -j1 and with -j<N> and the annotated ASTs as well as the exit codes must match.
+
+import argparse
+import difflib
+import subprocess
+import sys
+
+
+def annotated(impala, filename, jobs, timeout):
+    completed = subprocess.run([impala, filename, '-emit-annotated', '-j', str(jobs)],
+                               stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, timeout=timeout)
+    return completed.returncode, completed.stdout.decode('utf-8', 'replace')
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument('testfile',    nargs='+', help='path to one or multiple test files')
+    parser.add_argument('-i', '--impala',         help='path to impala',                    type=str, required=True)
+    parser.add_argument('-j', '--jobs',           help='number of threads to compare with', type=int, default=8)
+    parser.add_argument('-t', '--timeout',        help='timeout for each compilation',      type=int, default=10)
+    args = parser.parse_args()
+
+    failed = []
+    for filename in args.testfile:
+        serial_code,   serial   = annotated(args.impala, filename, 1,         args.timeout)
+        parallel_code, parallel = annotated(args.impala, filename, args.jobs, args.timeout)
+        if serial_code != parallel_code or serial != parallel:
+            failed.append(filename)
+            print('{}: -j1 and -j{} differ (exit codes {} and {})'.format(filename, args.jobs, serial_code, parallel_code))
+            diff = difflib.unified_diff(serial.splitlines(), parallel.splitlines(), '-j1', '-j{}'.format(args.jobs), lineterm='')
+            for line in diff:
+                print(line)
+
+    print('{} of {} file(s) differ'.format(len(failed), len(args.testfile)))
+    sys.exit(1 if failed else 0)
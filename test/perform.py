@@ -67,7 +67,8 @@ class RunImpalaCompile(TestMethod):
         self.flags = add_flags
 
     def __call__(self, testfile, addflags):
-        super().__call__(["-emit-llvm", "-O2", "-o", testfile.intermediate(), testfile.filename()] + self.flags)
+        flags = self.flags + [flag for flag in addflags if flag.startswith('-') and not flag.startswith('-l')]
+        super().__call__(["-emit-llvm", "-O2", "-o", testfile.intermediate(), testfile.filename()] + flags)
 
         self.dump_output(testfile.intermediate('.log'))
 
@@ -86,6 +87,36 @@ class RunImpalaCompile(TestMethod):
 
         return True
 
+class CheckImpalaIR(TestMethod):
+    """Compiles to textual Thorin; each '// CHECK: text' line of the test must occur in it and each '// CHECK-NOT: text' must not."""
+    def __init__(self, impala, add_flags=[], timeout=None):
+        super().__init__(impala, timeout=timeout)
+        self.flags = add_flags
+
+    def __call__(self, testfile, addflags):
+        flags = self.flags + [flag for flag in addflags if flag.startswith('-')]
+        super().__call__(["-emit-thorin", testfile.filename()] + flags)
+
+        self.dump_output(testfile.intermediate('.thorin'), to_stdout=False)
+
+        if self.wrong_returncode():
+            self.dump_output(None)
+            print("Impala returned wrong returncode")
+            return False
+
+        ir = str(self.stdout, 'utf-8', 'ignore')
+        result = True
+        with open(testfile.filename(), 'r') as source:
+            for line in source:
+                line = line.strip()
+                for prefix, expected in (('// CHECK:', True), ('// CHECK-NOT:', False)):
+                    if line.startswith(prefix):
+                        pattern = line[len(prefix):].strip()
+                        if (pattern in ir) != expected:
+                            print("Thorin", "lacks" if expected else "contains", repr(pattern), "- see", testfile.intermediate('.thorin'))
+                            result = False
+        return result
+
 class LinkFakeRuntime(TestMethod):
     def __init__(self, clang, runtime, add_flags=[]):
         super().__init__(clang)
@@ -248,7 +279,8 @@ if __name__ == '__main__':
             RunImpalaCompile(args.impala, impala_flags, timeout=args.compile_timeout),
             LinkFakeRuntime(args.clang, args.rtmock, clang_flags),
             ExecuteTestOutput(timeout=args.run_timeout)
-        )
+        ),
+        'thorin' : CheckImpalaIR(args.impala, impala_flags, timeout=args.compile_timeout)
     }
 
     action = "Fail" if args.pedantic else "Skip"